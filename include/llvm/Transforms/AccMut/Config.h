@@ -4,6 +4,21 @@
 //SWITCH FOR IR-LEVEL MUTATION GENERATION
 #define ACCMUT_GEN_MUT 0
 
+//SWITCH FOR GENERATING ONLY THE NON-REDUNDANT MUTANTS, SEE MutationGen.cpp
+#define ACCMUT_GEN_MUT_PRUNE 0
+
+//SWITCH FOR DROPPING THE MUTANTS THAT -O2 COMPILES TO THE ORIGINAL OR TO ANOTHER MUTANT, SEE MutationTCE.h
+#define ACCMUT_GEN_MUT_TCE 0
+
+//SWITCH FOR DROPPING THE MUTANTS THAT VALUETRACKING AND SCEV PROVE EQUIVALENT, SEE MutationGen.cpp
+#define ACCMUT_GEN_MUT_KNOWN_BITS 0
+
+//SWITCH FOR REUSING THE MUTANTS OF THE FUNCTIONS WHOSE IR HASH IS THE SAME, SEE MutationIncr.h
+#define ACCMUT_GEN_MUT_INCREMENTAL 0
+
+//SWITCH FOR WRITING THE MUTANTS OF EVERY MODULE TO ITS OWN SHARD, MERGED BY mutdb merge, SEE MutationDB.h
+#define ACCMUT_GEN_MUT_SHARDS 0
+
 //SWITCH FOR MUTATION SCHEMATA
 #define ACCMUT_MUTATION_SCHEMATA 0
 
@@ -19,6 +34,10 @@
 //SWITCH FOR SOME STATISTICS
 #define ACCMUT_STATISTICS_INSTRUEMENT 0
 
-#define MAX_MUT_NUM_PER_LOCATION 64
+//SWITCH FOR DETERMINISTIC TIMEOUTS, COUNTS BACK EDGES AND FUNCTION ENTRIES
+#define ACCMUT_EXEC_BUDGET_INSTRUMENT 0
+
+//SWITCH FOR EMBEDDING THE MUTANT TABLE INTO THE INSTRUMENTED MODULES
+#define ACCMUT_EMBED_MUTATIONS 1
 
 #endif
@@ -26,13 +26,12 @@ public:
 	static char ID;// Pass identification, replacement for typeid
 	virtual void getAnalysisUsage(AnalysisUsage &AU) const;
 	virtual bool runOnFunction(Function &F);
+	virtual bool doFinalization(Module &M);
 	DMAInstrumenter(Module *M);	
 private:
 	void instrument(Function &F, vector<Mutation*> * v);
-    BasicBlock::iterator getLocation(Function &F, int instrumented_insts, int index);
-    bool hasMutation(Instruction *inst, vector<Mutation*>* v);
-    bool needInstrument(Instruction *I, vector<Mutation*>* v);    
     Module *TheModule;
+    vector<Instruction*> Insts;	// the instructions of the function by index, see MutUtil::getInstructions
 };
 
 #endif
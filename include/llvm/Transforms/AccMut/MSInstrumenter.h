@@ -29,8 +29,9 @@ public:
 	MSInstrumenter(Module *M);
 private:	
 	void filtMutsByIndex(Function &F, vector<Mutation*>* v);
-	int instrument(Function &F, vector<Mutation *>* v, int index, int mut_from, int mut_to, int instrumented_insts);
+	void instrument(Function &F, vector<Mutation *>* v, int index, int mut_from, int mut_to);
 	Module *TheModule;
+	vector<Instruction*> Insts;	// the instructions of the function by index, see MutUtil::getInstructions
 };
 
 #endif
@@ -1,6 +1,7 @@
 //===----------------------------------------------------------------------===//
 //
-// This file provides utils to load $HOME/tmp/accmut/mutations.txt to AllMutsMap
+// This file provides utils to load $HOME/tmp/accmut/mutations.db (or
+// mutations.txt if there is no db) to AllMutsMap
 // 
 // Add by Wang Bo. DEC 22, 2015
 //
@@ -10,6 +11,7 @@
 #define ACCMUT_MUT_UTIL_H
 
 #include "llvm/Transforms/AccMut/Mutation.h"
+#include "llvm/Transforms/AccMut/MutationDB.h"
 #include "llvm/Transforms/AccMut/Config.h"
 
 #include "llvm/IR/Function.h"
@@ -40,13 +42,20 @@ using namespace llvm;
 class MutUtil{
 public:
 	static map<string, vector<Mutation*>* > AllMutsMap;
+	static vector<MutDBRecord> AllRecords;	// the runtime record of mutant i is AllRecords[i - 1]
+	static vector<unsigned long> AllKeys;	// the stable key of mutant i is AllKeys[i - 1], see MutationKey.h
 	static void getAllMutations();
+	static void embedMutations(Module &M);
 	static void dumpAllMuts();
-	static BasicBlock::iterator getLocation(Function &F, int instrumented_insts, int index);
+	// the instructions of F by the index of MutationGen, taken before the
+	// instrumentation inserts or removes any, so that finding the instruction
+	// of a mutant is no walk over F
+	static void getInstructions(Function &F, vector<Instruction*> &insts);
+	static BasicBlock::iterator getLocation(Function &F, const vector<Instruction*> &insts, int index);
     static int getOperandPtrDimension(Value* v);
 private:
 	static bool allMutsGeted;
-	static Mutation * getMutation(string line, int id);
+	static Mutation * getMutation(const MutDBRecord &rec, const string &func, int index, int id);
 };
 
 
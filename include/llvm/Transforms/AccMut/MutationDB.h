@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+// This file provides the binary mutation database $HOME/tmp/accmut/mutations.db
+//
+// The db holds the same mutants as mutations.txt: a header, a fixed size
+// record per mutant and a per-function index, so it is mapped, not parsed.
+// The layout must stay the same as tools/accmut/link/accmut_mutdb.h, the
+// records are the Mutation struct of the runtime.
+//
+// The generator of a module only appends its lines to mutations.txt. The
+// db is built from the whole text once, by the first instrumenter that
+// finds it missing or stale (a different size or hash of the text), or by
+// `mutdb txt2db`.
+//
+// With ACCMUT_GEN_MUT_SHARDS every module writes its own shard instead,
+// $HOME/tmp/accmut/shards/<MODULE>/mutations.txt (and funchash.txt, tce.txt),
+// replacing the one of its last compilation. No compiler waits for another
+// under make -j, and the ids do not depend on which one finishes first:
+// `mutdb merge` puts the shards together in the order of their names and
+// writes mutations.txt and the db.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ACCMUT_MUTATION_DB_H
+#define ACCMUT_MUTATION_DB_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define ACCMUT_DB_MAGIC 0x42444341	/* "ACDB" */
+#define ACCMUT_DB_VERSION 3
+
+struct MutDBHeader{
+	unsigned magic;
+	unsigned version;
+	int mut_num;
+	int func_num;
+	int rec_size;
+	int reserved;
+	long text_size;		// mutations.txt the db was built from, the db is stale
+	unsigned long text_hash;	// once the text is changed by hand or removed
+	long rec_off;
+	long loc_off;
+	long func_off;
+	long str_off;
+	long str_size;
+};
+
+// the Mutation struct of the runtime, type is a Mutation::MutationKind
+struct MutDBRecord{
+	int type;
+	int location;
+	int sop;
+	int op_0;
+	long op_1;
+	long op_2;
+};
+
+struct MutDBLoc{
+	int name_off;	// the function, offset in the string table
+	int index;		// the instruction, negative in a loop
+	unsigned long key;	// the stable key, see MutationKey.h, 0 if none
+};
+
+// a run of consecutive mutants of one function
+struct MutDBFunc{
+	int name_off;
+	int first;
+	int count;
+	int reserved;
+};
+
+class MutationDB{
+public:
+	const MutDBHeader *Header;
+	const MutDBRecord *Records;	// mutant i is Records[i - 1]
+	const MutDBLoc *Locs;
+	const MutDBFunc *Funcs;
+	const char *StrTab;
+
+	MutationDB();
+	~MutationDB();
+
+	// map the db read only, false if it is missing, broken or stale
+	bool open();
+	void close();
+
+	static std::string getTextPath();
+	static std::string getDBPath();
+
+	// append the mutations.txt lines of one module to the text, the db is
+	// built from the whole text once, see build
+	static void appendModule(const std::string &lines);
+
+	// the shard directory of a module, named after the absolute path of its identifier
+	static std::string getShardDir(const std::string &module);
+
+	// replace the file of the shard of a module, see ACCMUT_GEN_MUT_SHARDS
+	static void writeShard(const std::string &module, const std::string &file, const std::string &content);
+
+	// parse one line of mutations.txt, false for an unknown mutation type
+	static bool parseLine(const std::string &line, MutDBRecord &rec, std::string &func, int &index);
+
+	// the key at the end of a line of mutations.txt, 0 if it has none
+	static unsigned long parseKey(const std::string &line);
+
+	// the FNV-1a hash of mutations.txt, the staleness check of the db
+	static unsigned long hashText(const char *data, size_t size);
+
+	// the mutants in memory, mutant i is recs[i - 1]
+	struct Entries{
+		std::vector<MutDBRecord> recs;
+		std::vector<MutDBLoc> locs;	// name_off is an index in names
+		std::vector<std::string> names;
+		long text_size;				// the text they were parsed from
+		unsigned long text_hash;
+		Entries() : text_size(0), text_hash(0){}
+	};
+
+	// parse the whole mutations.txt, false if there is none
+	static bool loadText(Entries &ents);
+
+	// write the db of the mutants of loadText, false on a file error
+	static bool build(Entries &ents);
+
+	// the IR locations of the static analysis eval, the same as the runtime
+	static void setLocations(Entries &ents);
+
+private:
+	void *Map;
+	size_t Size;
+
+	static void addLines(std::istream &in, Entries &ents);
+};
+
+#endif
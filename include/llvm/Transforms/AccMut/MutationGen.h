@@ -14,7 +14,7 @@
 
 #include "llvm/IR/Module.h"
 
-#include <fstream>
+#include <sstream>
 
 using namespace llvm;
 
@@ -24,9 +24,11 @@ public:
 	virtual void getAnalysisUsage(AnalysisUsage &AU) const;
 
 	Module *TheModule;
-	static std::ofstream  ofresult; 
+	//the lines of the module, appended to mutations.txt and mutations.db at the end
+	static std::stringstream  ofresult; 
 	MutationGen(Module *M);
 	virtual bool runOnFunction(Function &F);
+	virtual bool doFinalization(Module &M);
 	static void genMutationFile(Function & F);
 private:
 	static void genAOR(Instruction *inst,StringRef fname, int index);
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+// This file describes the incremental generation of the mutation generator
+//
+// Every function is hashed: the MD5 of its IR without the debug info and
+// without the names of the values. The hash and the functions it calls go
+// to $HOME/tmp/accmut/funchash.txt, one line per function:
+//   FUNC HASH CALLEE,CALLEE,...	("-" if it calls none)
+// If $HOME/tmp/accmut/prev/ holds the funchash.txt and the mutations.txt of
+// the last generation, a function with the same hash gets its old lines of
+// mutations.txt instead of being generated again. tools/accmut/utils/carryover
+// then carries the kill results of its mutants forward.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ACCMUT_MUTATION_INCR_H
+#define ACCMUT_MUTATION_INCR_H
+
+#include "llvm/Transforms/AccMut/Config.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+
+using namespace llvm;
+
+class MutationIncr{
+public:
+	// hash F and add its line to the table, returns the hash
+	static std::string addFunction(Function &F);
+
+	// the mutations.txt lines of the last generation of F, false if F is
+	// new or its hash is not the same
+	static bool getPrevious(Function &F, const std::string &hash, std::string &lines);
+
+	// append the table of the module to funchash.txt, or write its shard
+	static void appendTable(Module &M);
+
+private:
+	// the lines of funchash.txt of the module
+	static std::stringstream table;
+
+	static bool prevLoaded;
+	static std::map<std::string, std::string> prevHashes;
+	static std::map<std::string, std::string> prevLines;
+
+	static void loadPrevious();
+};
+
+#endif
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+// This file describes the stable keys of the mutants
+//
+// The id of a mutant is its line in mutations.txt and its location is the
+// index of its instruction in the function, both change with any edit before
+// it. The key of a mutant only depends on what it mutates: a 64 bit FNV-1a
+// hash of the function name, the hash of the opcodes of its basic block,
+// the hash of its instruction (opcode, type and operands) and the operator
+// with its parameters. Equal keys in one function (e.g. the same instruction
+// twice in a block) are told apart by hashing again in the order of the
+// function. The key is written at the end of the line of the mutant as
+// " #KEY" (16 hex digits), the parsers of the lines skip it. The ids stay
+// dense: they are still given when the lines of all the modules are put
+// together, and the runtime indexes its arrays with them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ACCMUT_MUTATION_KEY_H
+#define ACCMUT_MUTATION_KEY_H
+
+#include "llvm/Transforms/AccMut/Config.h"
+
+#include "llvm/IR/Function.h"
+
+#include <string>
+
+using namespace llvm;
+
+class MutationKey{
+public:
+	// the mutations.txt lines of F with their keys
+	static std::string addKeys(Function &F, const std::string &lines);
+
+private:
+	static unsigned long hashBlock(BasicBlock *BB);
+	static unsigned long hashInst(Instruction *I);
+};
+
+#endif
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+// This file describes the trivial compiler equivalence (TCE) filter of the
+// mutation generator
+//
+// Every mutant of a function is applied to a copy of the function, the copy
+// is optimized with the scalar -O2 function passes and the result is hashed.
+// A mutant whose code is the same as the optimized original is equivalent,
+// one whose code is the same as an earlier mutant is a duplicate. Neither
+// goes to mutations.txt, they are listed in $HOME/tmp/accmut/tce.txt.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef ACCMUT_MUTATION_TCE_H
+#define ACCMUT_MUTATION_TCE_H
+
+#include "llvm/Transforms/AccMut/MutationDB.h"
+#include "llvm/Transforms/AccMut/Config.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+
+#include <sstream>
+#include <string>
+
+using namespace llvm;
+
+class MutationTCE{
+public:
+	// the mutations.txt lines of F without the equivalent and the duplicate
+	// mutants, dropped is the number of the lines left out
+	static std::string filter(Function &F, const std::string &lines, int &dropped);
+
+	// append the table of the module to tce.txt, or write its shard
+	static void appendTable(Module &M);
+
+	// a copy of F in its module without the debug info, erase it when done,
+	// keepDebug leaves the debug info for the indexes of mutations.txt
+	static Function *copyFunction(Function &F, bool keepDebug = false);
+
+	// the MD5 in hex of a copy as printed, the names of the values left out
+	static std::string hashFunction(Function *copy);
+
+private:
+	// the lines of tce.txt of the module, "EQ LINE" or "DUP LINE FIRST_LINE"
+	static std::stringstream table;
+
+	// apply the mutant to the I of a copy, false if it can not be applied
+	static bool applyMutation(Instruction *I, const MutDBRecord &rec);
+
+	// drop the debug intrinsics and locations of a copy
+	static void stripDebugInfo(Function *copy);
+
+	// the copy of F, optimized by FPM, its MD5 in hex
+	static std::string getDigest(Function *copy, legacy::FunctionPassManager &FPM);
+};
+
+#endif
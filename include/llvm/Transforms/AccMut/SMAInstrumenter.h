@@ -26,6 +26,7 @@ public:
 	static char ID;// Pass identification, replacement for typeid
 	virtual void getAnalysisUsage(AnalysisUsage &AU) const;
 	virtual bool runOnFunction(Function &F);
+	virtual bool doFinalization(Module &M);
 	SMAInstrumenter(Module *M);
 private:	
 	bool hasMutation(Instruction *I, vector<Mutation*>* v);
@@ -34,8 +35,8 @@ private:
 	static void outputMutation(Instruction *inst, vector<Mutation*>* v);
 	
 	void instrument(Function &F, vector<Mutation*> * v);
-	BasicBlock::iterator getLocation(Function &F, int instrumented_insts, int index);
 	Module *TheModule;
+	vector<Instruction*> Insts;	// the instructions of the function by index, see MutUtil::getInstructions
 	static ofstream  expr_os;
 	static ofstream  mut_os;
 };
@@ -39,5 +39,21 @@ private:
 	Module *TheModule;
 };
 
+/*
+* Deterministic timeouts: counts the function entries and the loop back
+* edges in __accmut__exec_count, a mutant over __accmut__exec_limit (a
+* multiple of the count of the original on the test, set by the runtime)
+* calls __accmut__exec_budget_exceeded() and ends as a timeout.
+*/
+class ExecBudget: public FunctionPass{
+public:
+	static char ID;// Pass identification, replacement for typeid
+	virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+	virtual bool runOnFunction(Function &F);
+	ExecBudget(Module *M);
+private:
+	Module *TheModule;
+	void insertTick(Instruction *before);
+};
 
 #endif
\ No newline at end of file
@@ -247,6 +247,15 @@ static void test(Function &F){
 	}	
 }
 
+bool DMAInstrumenter::doFinalization(Module &M){
+#if ACCMUT_EMBED_MUTATIONS
+	MutUtil::embedMutations(M);
+	return true;
+#else
+	return false;
+#endif
+}
+
 bool DMAInstrumenter::runOnFunction(Function & F){
 	if(F.getName().startswith("__accmut__")){
 		return false;
@@ -262,6 +271,9 @@ bool DMAInstrumenter::runOnFunction(Function & F){
 
 	errs()<<"\n######## DMA INSTRUMTNTING MUT  @"<<TheModule->getName()<<"->"<<F.getName()<<"()  ########\n\n";	
 
+	//the indexes of the mutants are the ones of F before instrumenting
+	MutUtil::getInstructions(F, Insts);
+
 	instrument(F, v);
 	//test(F);
 
@@ -357,8 +369,6 @@ static bool pushPreparecallParam(std::vector<Value*>& params, int index, Value *
 }
 
 void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
-
-	int instrumented_insts = 0;
 	
 	Function::iterator cur_bb;
 	BasicBlock::iterator cur_it;
@@ -378,7 +388,7 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 			}
 		}
 		
-		cur_it =  getLocation(F, instrumented_insts, tmp[0]->index);
+		cur_it =  MutUtil::getLocation(F, Insts, tmp[0]->index);
 
 		cur_bb = cur_it->getParent();
 
@@ -386,13 +396,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 		mut_from = tmp.front()->id;
 		mut_to = tmp.back()->id;
 
-		if(tmp.size() >= MAX_MUT_NUM_PER_LOCATION){
-			ERRMSG("TOO MANY MUTS ");
-			llvm::errs()<<"CUR_INST: "<<tmp.front()->index<<"\t(FROM: "
-				<<mut_from<<"\tTO: "<<mut_to<<")\t"<<*cur_it<<"\n";
-			exit(0);
-		}
-		
 		llvm::errs()<<"CUR_INST: "<<tmp.front()->index<<"\t(FROM: "
 			<<mut_from<<"\tTO: "<<mut_to<<")\t"<<*cur_it<<"\n";
 		
@@ -404,7 +407,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 					StoreInst *str = new StoreInst(cons, alloca, cur_it);
 					LoadInst *ld = new LoadInst(alloca, (cons->getName().str()+".ld"), cur_it);
 					*OI = (Value*) ld;
-					instrumented_insts += 3;//add 'alloca', 'store' and 'load'
 				}
 				else if(Instruction* oinst = dyn_cast<Instruction>(&*OI)){
 					if(oinst->isBinaryOp() || 
@@ -416,7 +418,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 						StoreInst *str = new StoreInst(oinst, alloca, cur_it);
 						LoadInst *ld = new LoadInst(alloca, (oinst->getName().str()+".ld"), cur_it);
 						*OI = (Value*) ld;
-						instrumented_insts += 3;
 						
 					}
 				}
@@ -549,7 +550,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 					label_if_then->getInstList().push_back(ge);
 				}else{
 					// TODO:: check
-					// TODO:: instrumented_insts !!!
 					Instruction *coversion = dyn_cast<Instruction>(&*OI);
 					if(isHandledCoveInst(coversion)){
 						Instruction* op_of_cov = dyn_cast<Instruction>(coversion->getOperand(0));
@@ -687,14 +687,12 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 			//label_if_end
 			if(oricall->getType()->isVoidTy()){
 				cur_it->eraseFromParent();
-				instrumented_insts += 6;
 			}
 			else{
 				PHINode* call_res = PHINode::Create(oricall->getType(), 2, "call.phi");
 				call_res->addIncoming(oricall, label_if_then);
 				call_res->addIncoming(stdcall, label_if_else);
 				ReplaceInstWithInst(cur_it, call_res);
-				instrumented_insts += 7;
 			}
 
 		}
@@ -707,7 +705,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 					LoadInst *ld = new LoadInst(alloca, "const_load", st);
 					User::op_iterator OI = st->op_begin();
 					*OI = (Value*) ld;
-					instrumented_insts += 3;
 			}
 
 			Function* prestfunc;
@@ -875,7 +872,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 
 			//label_if_end
 			cur_it->eraseFromParent();	
-			instrumented_insts += 4;
 		}
 		else{
 			// FOR ARITH INST
@@ -1059,8 +1055,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 				int_call_params.push_back(cur_it->getOperand(1));
 				CallInst *call = CallInst::Create(f_process, int_call_params, "", cur_it);
 				CastInst* i32_conv = new TruncInst(call, IntegerType::get(TheModule->getContext(), 1), "");
-
-				instrumented_insts++;
 				
 				ReplaceInstWithInst(cur_it, i32_conv);
 			}
@@ -1074,43 +1068,6 @@ void DMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 #undef INT_TP
 #undef LONG_TP
 
-BasicBlock::iterator DMAInstrumenter::getLocation(Function &F, int instrumented_insts, int index){
-	int cur = 0;
-	for(Function::iterator FI = F.begin(); FI != F.end(); ++FI){
-		BasicBlock *BB = FI;
-		for(BasicBlock::iterator BI = BB->begin(); BI != BB->end(); ++BI, cur++){
-			if(index + instrumented_insts == cur ){
-				return BI;
-			}
-		}
-	}
-	return F.back().end();
-}
-
-bool DMAInstrumenter::hasMutation(Instruction *inst, vector<Mutation*>* v){
-	int index = 0;
-	Function *F = inst->getParent()->getParent();
-
-	for(inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I, index++) {
-		if((&*I) == inst){
-			break;
-		}
-	}
-
-	//errs()<<" ~~~~~ INDEX : "<<index<<"\n";
-	for(vector<Mutation*>::iterator it = v->begin(), end = v->end(); it != end; it++){
-		if( (*it)->index == index){
-			return true;
-		}else if((*it)->index > index){// TODO: check
-			return false;
-		}
-	}
-	return false;
-}
-
-
-
-
 /*------------------reserved begin-------------------*/
 void DMAInstrumenter::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
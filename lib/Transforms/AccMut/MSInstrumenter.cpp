@@ -66,27 +66,20 @@ void MSInstrumenter::filtMutsByIndex(Function &F, vector<Mutation*>* v){
 	errs()<<"===  MS INSTRUMENTING "<<F.getName()<<"  =====\n";
 	std::vector<Mutation*>::iterator cur_mut = v->begin();
 	std::vector<Mutation*>::iterator beg = cur_mut;
-	int instrumented_insts = 0;
+	MutUtil::getInstructions(F, Insts);
 	while(cur_mut != v->end()){
 		if((*cur_mut)->index != (*beg)->index){
 //			errs()<<"IR "<<(*beg)->index<<" : mut "<<(*beg)->id<<" ~~ mut "<<(*(cur_mut-1))->id<<"\n";
-//						errs()<<" II : "<<instrumented_insts<<"\n";
 
-			int insts = instrument(F, v, (*beg)->index, (*beg)->id, (*(cur_mut-1))->id, instrumented_insts);
-			instrumented_insts+=insts;
-
-//			errs()<<" III : "<<instrumented_insts<<"\n";
+			instrument(F, v, (*beg)->index, (*beg)->id, (*(cur_mut-1))->id);
 
 			beg = cur_mut;
 			continue;
 		}
 		if(cur_mut == (v->end() -1)){
 //			errs()<<(*beg)->index<<" : "<<(*beg)->id<<"~"<<(*cur_mut)->id<<"\n";
-//						errs()<<" II : "<<instrumented_insts<<"\n";
 
-			int insts = instrument(F, v, (*beg)->index, (*beg)->id, (*cur_mut)->id, instrumented_insts);
-			instrumented_insts+=insts;
-//			errs()<<" III : "<<instrumented_insts<<"\n";
+			instrument(F, v, (*beg)->index, (*beg)->id, (*cur_mut)->id);
 		}
 		cur_mut++;
 	}
@@ -96,10 +89,9 @@ void MSInstrumenter::filtMutsByIndex(Function &F, vector<Mutation*>* v){
 }
 
 
-int MSInstrumenter::instrument(Function &F, vector<Mutation *>* v, int index, int mut_from, int mut_to, int instrumented_insts){
-	int insts = 0;
+void MSInstrumenter::instrument(Function &F, vector<Mutation *>* v, int index, int mut_from, int mut_to){
 	
-	BasicBlock::iterator cur_it = MutUtil::getLocation(F, instrumented_insts, index);
+	BasicBlock::iterator cur_it = MutUtil::getLocation(F, Insts, index);
 
 	errs()<<">>INSTRUMENTING MUTS FROM "<<mut_from<<" TO "<<mut_to<<" IN IR "<<index<<" >> ";
 	cur_it->dump();
@@ -3,15 +3,14 @@
 
 #include "llvm/Transforms/AccMut/MutUtil.h"
 
-#include<fstream>
-#include<sstream>
-
 
 using namespace llvm;
 using namespace std;
 
 bool MutUtil::allMutsGeted = false;
 map<string, vector<Mutation*>*> MutUtil::AllMutsMap;
+vector<MutDBRecord> MutUtil::AllRecords;
+vector<unsigned long> MutUtil::AllKeys;
 
 
 void MutUtil::dumpAllMuts(){
@@ -34,27 +33,50 @@ void MutUtil::getAllMutations(){
 	if(allMutsGeted){
 		return;
 	}
-	string buf;
-	string path = getenv("HOME");
-	path += "/tmp/accmut/mutations.txt";
-	
-	std::ifstream  fin(path, ios::in); 
-	
-	if(!fin.is_open()){
-		errs()<<"FILE ERROR : mutations.txt @ "<<path<<"\n";
+
+	MutationDB db;
+	if(db.open()){
+		AllRecords.assign(db.Records, db.Records + db.Header->mut_num);
+		for(int i = 0; i < db.Header->mut_num; i++){
+			AllKeys.push_back(db.Locs[i].key);
+		}
+		for(int f = 0; f < db.Header->func_num; f++){
+			const MutDBFunc &fn = db.Funcs[f];
+			string func = db.StrTab + fn.name_off;
+			if(AllMutsMap.count(func) == 0){
+				AllMutsMap[func] = new vector<Mutation*>();
+			}
+			vector<Mutation*> *v = AllMutsMap[func];
+			for(int id = fn.first; id < fn.first + fn.count; id++){
+				v->push_back(getMutation(db.Records[id - 1], func, db.Locs[id - 1].index, id));
+			}
+		}
+		allMutsGeted = true;
+		return;
+	}
+
+	MutationDB::Entries ents;
+	if(!MutationDB::loadText(ents)){
+		errs()<<"FILE ERROR : mutations.txt @ "<<MutationDB::getTextPath()<<"\n";
 		exit(-1);
 	}
+	//the generators only append to the text, the first instrumenter builds
+	//the db for the others, build sets the locations too
+	if(!MutationDB::build(ents)){
+		errs()<<"FILE ERROR : mutations.db @ "<<MutationDB::getDBPath()<<"\n";
+		MutationDB::setLocations(ents);
+	}
 
-	int id = 1;
-	while( fin>>buf) { 
-		Mutation *m = getMutation(buf, id);
-		id++;
+	for(unsigned i = 0; i < ents.recs.size(); i++){
+		const string &func = ents.names[ents.locs[i].name_off];
+		Mutation *m = getMutation(ents.recs[i], func, ents.locs[i].index, i + 1);
 		if(AllMutsMap.count(m->func) == 0){
 			AllMutsMap[m->func] = new vector<Mutation*>();
 		}
 		AllMutsMap[m->func]->push_back(m);
+		AllKeys.push_back(ents.locs[i].key);
 	}
-	fin.close();
+	AllRecords.swap(ents.recs);
 	allMutsGeted = true;
 
 	#if 0
@@ -62,111 +84,149 @@ void MutUtil::getAllMutations(){
 	#endif
 }
 
-Mutation *MutUtil::getMutation(string line, int id){
-	stringstream ss;
-	ss<<line;
-	string mtype, func;
-	int index, sop;
-	char colon;
-	getline(ss, mtype, ':');
-	getline(ss, func, ':');
-	ss>>index;
-	ss>>colon;
-	ss>>sop;
-	ss>>colon;
-	
+Mutation *MutUtil::getMutation(const MutDBRecord &rec, const string &func, int index, int id){
+	static const char *names[] = {"AOR", "LOR", "COR", "ROR", "SOR", "STD", "LVR", "UOI", "ROV", "ABV"};
+
 	Mutation *m;
-	if(mtype == "AOR"){
-		AORMut *aor = new AORMut();
-		int top;
-		ss>>top;
-		aor->tar_op = top;
-		m = dyn_cast<Mutation>(aor);
-	}else if(mtype == "LOR"){
-		LORMut *lor = new LORMut();
-		int top;
-		ss>>top;
-		lor->tar_op = top;
-		m = dyn_cast<Mutation>(lor);
-	}else if(mtype == "COR"){
-
-	}else if(mtype == "ROR"){
-		RORMut *ror = new RORMut();
-		int sp, tp;
-		ss>>sp;
-		ss>>colon;
-		ss>>tp;
-		ror->src_pre = sp;
-		ror->tar_pre = tp;
-		m = dyn_cast<Mutation>(ror);
-	}else if(mtype == "SOR"){
-		
-	}else if(mtype == "STD"){
-		STDMut *std = new STDMut();
-		int type;
-		ss>>type;
-		std->func_ty = type;
-		m = dyn_cast<Mutation>(std);
-	}else if(mtype == "LVR"){
-		LVRMut *lvr = new LVRMut();
-		int oi, sc, tc;	
-		ss>>oi;
-		ss>>colon;
-		ss>>sc;
-		ss>>colon;
-		ss>>tc;
-		lvr->oper_index = oi;
-		lvr->src_const = sc;
-		lvr->tar_const = tc;
-		m = dyn_cast<Mutation>(lvr);
-	}else if(mtype == "UOI"){
-		UOIMut *uoi = new UOIMut();
-		int oi, ut;	
-		ss>>oi;
-		ss>>colon;
-		ss>>ut;
-		uoi->ury_tp = ut;
-		m = dyn_cast<Mutation>(uoi);
-	}else if (mtype == "ROV"){
-		ROVMut *rov = new ROVMut();
-		int op1, op2;
-		ss>>op1;
-		ss>>colon;
-		ss>>op2;
-		rov->op1 = op1;
-		rov->op2 = op2;
-		m = dyn_cast<Mutation>(rov);
-	}else if(mtype == "ABV"){
-		ABVMut *abv = new ABVMut();
-		int opindex;
-		ss>>opindex;
-		abv->oper_index;
-		m = dyn_cast<Mutation>(abv);
-	}else{
-		errs()<<"WRONG MUT TYPE !\n";
-		exit(-1);
+	switch(rec.type){
+		case Mutation::MK_AOR:{
+			AORMut *aor = new AORMut();
+			aor->tar_op = rec.op_0;
+			m = dyn_cast<Mutation>(aor);
+			break;
+		}
+		case Mutation::MK_LOR:{
+			LORMut *lor = new LORMut();
+			lor->tar_op = rec.op_0;
+			m = dyn_cast<Mutation>(lor);
+			break;
+		}
+		case Mutation::MK_ROR:{
+			RORMut *ror = new RORMut();
+			ror->src_pre = rec.op_1;
+			ror->tar_pre = rec.op_2;
+			m = dyn_cast<Mutation>(ror);
+			break;
+		}
+		case Mutation::MK_STD:{
+			STDMut *std = new STDMut();
+			std->func_ty = rec.op_1;
+			m = dyn_cast<Mutation>(std);
+			break;
+		}
+		case Mutation::MK_LVR:{
+			LVRMut *lvr = new LVRMut();
+			lvr->oper_index = rec.op_0;
+			lvr->src_const = rec.op_1;
+			lvr->tar_const = rec.op_2;
+			m = dyn_cast<Mutation>(lvr);
+			break;
+		}
+		case Mutation::MK_UOI:{
+			UOIMut *uoi = new UOIMut();
+			uoi->oper_index = rec.op_1;
+			uoi->ury_tp = rec.op_2;
+			m = dyn_cast<Mutation>(uoi);
+			break;
+		}
+		case Mutation::MK_ROV:{
+			ROVMut *rov = new ROVMut();
+			rov->op1 = rec.op_1;
+			rov->op2 = rec.op_2;
+			m = dyn_cast<Mutation>(rov);
+			break;
+		}
+		case Mutation::MK_ABV:{
+			ABVMut *abv = new ABVMut();
+			abv->oper_index = rec.op_0;
+			m = dyn_cast<Mutation>(abv);
+			break;
+		}
+		default:
+			errs()<<"WRONG MUT TYPE !\n";
+			exit(-1);
 	}
 	m->id = id;
-	m->type = mtype;
+	m->type = names[rec.type];
 	m->func = func;
 	m->index = abs(index);
-	m->src_op = sop;
+	m->src_op = rec.sop;
 	return m;
 }
 
-BasicBlock::iterator MutUtil::getLocation(Function &F, int instrumented_insts, int index){
-	int cur = 0;
-	//errs()<<"GETLOCATION : "<<instrumented_insts<<"    "<<index<<"\n";
+// The runtime records of the mutants of M, as the array @__accmut__muts of
+// {id, mut_num, Mutation} in the section "accmut_muts". The linker puts the
+// arrays of all the modules together between __start_accmut_muts and
+// __stop_accmut_muts, and the runtime takes ALLMUTS from there.
+void MutUtil::embedMutations(Module &M){
+	LLVMContext &C = M.getContext();
+	Type *i32 = Type::getInt32Ty(C);
+	Type *i64 = Type::getInt64Ty(C);
+	StructType *MutTy = StructType::get(i32, i32, i32, i32, i64, i64, nullptr);
+	StructType *EntTy = StructType::get(i32, i32, MutTy, i64, nullptr);
+
+	int mut_num = AllRecords.size();
+
+	vector<Constant*> ents;
+	for(Function &F : M){
+		if(F.isDeclaration() || AllMutsMap.count(F.getName()) == 0){
+			continue;
+		}
+		vector<Mutation*>* v = AllMutsMap[F.getName()];
+		for(vector<Mutation*>::iterator it = v->begin(); it != v->end(); ++it){
+			const MutDBRecord &r = AllRecords[(*it)->id - 1];
+			Constant *mut = ConstantStruct::get(MutTy,
+				ConstantInt::get(i32, r.type), ConstantInt::get(i32, r.location),
+				ConstantInt::get(i32, r.sop), ConstantInt::get(i32, r.op_0),
+				ConstantInt::get(i64, r.op_1), ConstantInt::get(i64, r.op_2), nullptr);
+			ents.push_back(ConstantStruct::get(EntTy,
+				ConstantInt::get(i32, (*it)->id), ConstantInt::get(i32, mut_num), mut,
+				ConstantInt::get(i64, AllKeys[(*it)->id - 1]), nullptr));
+		}
+	}
+
+	if(ents.empty()){
+		return;
+	}
+
+	ArrayType *AT = ArrayType::get(EntTy, ents.size());
+	GlobalVariable *GV = new GlobalVariable(M, AT, true, GlobalValue::InternalLinkage,
+		ConstantArray::get(AT, ents), "__accmut__muts");
+	GV->setSection("accmut_muts");
+	GV->setAlignment(8);
+
+	//nothing refers to it but the linker, keep it in llvm.used
+	Type *i8PTy = Type::getInt8PtrTy(C);
+	vector<Constant*> used;
+	GlobalVariable *LLVMUsed = M.getGlobalVariable("llvm.used");
+	if(LLVMUsed){
+		ConstantArray *Inits = cast<ConstantArray>(LLVMUsed->getInitializer());
+		for(unsigned i = 0; i < Inits->getNumOperands(); i++){
+			used.push_back(Inits->getOperand(i));
+		}
+		LLVMUsed->eraseFromParent();
+	}
+	used.push_back(ConstantExpr::getBitCast(GV, i8PTy));
+	ArrayType *UT = ArrayType::get(i8PTy, used.size());
+	LLVMUsed = new GlobalVariable(M, UT, false, GlobalValue::AppendingLinkage,
+		ConstantArray::get(UT, used), "llvm.used");
+	LLVMUsed->setSection("llvm.metadata");
+}
+
+void MutUtil::getInstructions(Function &F, vector<Instruction*> &insts){
+	insts.clear();
 	for(Function::iterator FI = F.begin(); FI != F.end(); ++FI){
-		BasicBlock *BB = FI;
-		for(BasicBlock::iterator BI = BB->begin(); BI != BB->end(); ++BI, cur++){
-			//errs()<<"\t"<<" CUR: "<<cur<<*BI<<"\n";
-			if(index + instrumented_insts == cur ){
-				return BI;
-			}
+		for(BasicBlock::iterator BI = FI->begin(); BI != FI->end(); ++BI){
+			insts.push_back(&*BI);
 		}
 	}
-	return F.back().end();	
+}
+
+BasicBlock::iterator MutUtil::getLocation(Function &F, const vector<Instruction*> &insts, int index){
+	if(index < 0 || (unsigned)index >= insts.size()){
+		return F.back().end();
+	}
+	return BasicBlock::iterator(insts[index]);
 }
 
 int MutUtil::getOperandPtrDimension(Value* v){// TODO: check for getElemPtr !
@@ -0,0 +1,380 @@
+//===----------------------------------------------------------------------===//
+//
+// This file implements the binary mutation database
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "llvm/Transforms/AccMut/MutationDB.h"
+#include "llvm/Transforms/AccMut/Mutation.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace llvm;
+using namespace std;
+
+static const char *MutTypeNames[] = {"AOR", "LOR", "COR", "ROR", "SOR", "STD", "LVR", "UOI", "ROV", "ABV"};
+
+#define MUT_TYPE_NUM (sizeof(MutTypeNames) / sizeof(MutTypeNames[0]))
+
+MutationDB::MutationDB() : Header(NULL), Records(NULL), Locs(NULL), Funcs(NULL),
+	StrTab(NULL), Map(NULL), Size(0){}
+
+MutationDB::~MutationDB(){
+	close();
+}
+
+string MutationDB::getTextPath(){
+	string path = getenv("HOME");
+	path += "/tmp/accmut/mutations.txt";
+	return path;
+}
+
+string MutationDB::getDBPath(){
+	string path = getenv("HOME");
+	path += "/tmp/accmut/mutations.db";
+	return path;
+}
+
+bool MutationDB::open(){
+	close();
+
+	int fd = ::open(getDBPath().c_str(), O_RDONLY);
+	if(fd < 0){
+		return false;
+	}
+	struct stat sb;
+	if(fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(MutDBHeader)){
+		::close(fd);
+		return false;
+	}
+	void *map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(map == MAP_FAILED){
+		return false;
+	}
+	Map = map;
+	Size = sb.st_size;
+
+	const MutDBHeader *h = (const MutDBHeader *)map;
+	long sz = Size;
+	if(h->magic != ACCMUT_DB_MAGIC || h->version != ACCMUT_DB_VERSION
+		|| h->rec_size != sizeof(MutDBRecord) || h->mut_num < 0 || h->func_num < 0
+		|| h->rec_off + (long)sizeof(MutDBRecord) * h->mut_num > sz
+		|| h->loc_off + (long)sizeof(MutDBLoc) * h->mut_num > sz
+		|| h->func_off + (long)sizeof(MutDBFunc) * h->func_num > sz
+		|| h->str_off + h->str_size > sz){
+		close();
+		return false;
+	}
+
+	//mutations.txt has been sampled by hand, appended to or removed since
+	if(stat(getTextPath().c_str(), &sb) != 0 || sb.st_size != h->text_size){
+		close();
+		return false;
+	}
+	//a same size edit within the same second keeps the size and the mtime
+	ifstream fin(getTextPath().c_str(), ios::in | ios::binary);
+	string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+	if((long)text.size() != h->text_size || hashText(text.data(), text.size()) != h->text_hash){
+		close();
+		return false;
+	}
+
+	Header = h;
+	Records = (const MutDBRecord *)((const char *)map + h->rec_off);
+	Locs = (const MutDBLoc *)((const char *)map + h->loc_off);
+	Funcs = (const MutDBFunc *)((const char *)map + h->func_off);
+	StrTab = (const char *)map + h->str_off;
+	return true;
+}
+
+void MutationDB::close(){
+	if(Map != NULL){
+		munmap(Map, Size);
+	}
+	Map = NULL;
+	Size = 0;
+	Header = NULL;
+	Records = NULL;
+	Locs = NULL;
+	Funcs = NULL;
+	StrTab = NULL;
+}
+
+bool MutationDB::parseLine(const string &line, MutDBRecord &rec, string &func, int &index){
+	char type[4] = {0};
+	vector<char> fbuf(line.size() + 1, 0);
+	vector<char> tail(line.size() + 1, 0);
+
+	if(sscanf(line.c_str(), "%3s:%[^:]:%d:%s", type, &fbuf[0], &index, &tail[0]) != 4){
+		return false;
+	}
+	func = &fbuf[0];
+
+	memset(&rec, 0, sizeof(rec));
+
+	unsigned t;
+	for(t = 0; t < MUT_TYPE_NUM; t++){
+		if(!strcmp(type, MutTypeNames[t])){
+			break;
+		}
+	}
+	rec.type = t;
+
+	switch(t){
+		case Mutation::MK_AOR:
+		case Mutation::MK_LOR:
+		case Mutation::MK_ABV:
+			//AOR,LOR: s_op:t_op, ABV: s_op:op_index
+			sscanf(&tail[0], "%d:%d", &rec.sop, &rec.op_0);
+			break;
+		case Mutation::MK_ROR:
+		case Mutation::MK_UOI:
+		case Mutation::MK_ROV:
+		case Mutation::MK_STD:
+			//ROR: s_pre:t_pre, UOI: op_index:tp, ROV: op1:op2, STD: f_tp[:retval]
+			sscanf(&tail[0], "%d:%ld:%ld", &rec.sop, &rec.op_1, &rec.op_2);
+			break;
+		case Mutation::MK_LVR:
+			sscanf(&tail[0], "%d:%d:%ld:%ld", &rec.sop, &rec.op_0, &rec.op_1, &rec.op_2);
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+unsigned long MutationDB::parseKey(const string &line){
+	size_t pos = line.rfind(" #");
+	if(pos == string::npos){
+		return 0;
+	}
+	return strtoul(line.c_str() + pos + 2, NULL, 16);
+}
+
+void MutationDB::addLines(istream &in, Entries &ents){
+	string line;
+	while(getline(in, line)){
+		if(line.empty()){
+			continue;
+		}
+		MutDBRecord rec;
+		MutDBLoc loc;
+		string func;
+		if(!parseLine(line, rec, func, loc.index)){
+			errs()<<"WRONG MUT TYPE : "<<line<<"\n";
+			exit(-1);
+		}
+		//the mutants of a function are always together
+		if(ents.names.empty() || ents.names.back() != func){
+			ents.names.push_back(func);
+		}
+		loc.name_off = ents.names.size() - 1;
+		loc.key = parseKey(line);
+		ents.recs.push_back(rec);
+		ents.locs.push_back(loc);
+	}
+}
+
+unsigned long MutationDB::hashText(const char *data, size_t size){
+	unsigned long hash = 14695981039346656037ul;
+	for(size_t i = 0; i < size; i++){
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ul;
+	}
+	return hash;
+}
+
+bool MutationDB::loadText(Entries &ents){
+	ifstream fin(getTextPath().c_str(), ios::in | ios::binary);
+	if(!fin.is_open()){
+		return false;
+	}
+	//the db built from ents is in sync with exactly the bytes parsed, even
+	//if a module appends meanwhile
+	string text((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+	ents.text_size = text.size();
+	ents.text_hash = hashText(text.data(), text.size());
+	stringstream ss(text);
+	addLines(ss, ents);
+	return true;
+}
+
+void MutationDB::setLocations(Entries &ents){
+	//count from 2 like the text loader of the runtime, negative in a loop
+	int cur_loc = 1;
+	int pre_name = -1;
+	int pre_idx = -1;
+	for(unsigned i = 0; i < ents.recs.size(); i++){
+		int name = ents.locs[i].name_off;
+		int idx = abs(ents.locs[i].index);
+		if(name != pre_name || idx != pre_idx){
+			cur_loc++;
+		}
+		ents.recs[i].location = ents.locs[i].index < 0 ? -cur_loc : cur_loc;
+		pre_name = name;
+		pre_idx = idx;
+	}
+}
+
+bool MutationDB::build(Entries &ents){
+	vector<int> offs;
+	string strtab;
+	for(unsigned i = 0; i < ents.names.size(); i++){
+		offs.push_back(strtab.size());
+		strtab += ents.names[i];
+		strtab.push_back('\0');
+	}
+
+	setLocations(ents);
+
+	vector<MutDBLoc> locs;
+	vector<MutDBFunc> funcs;
+	int pre_name = -1;
+	for(unsigned i = 0; i < ents.recs.size(); i++){
+		int name = ents.locs[i].name_off;
+		if(name != pre_name){
+			MutDBFunc f = {offs[name], (int)i + 1, 0, 0};
+			funcs.push_back(f);
+		}
+		funcs.back().count++;
+
+		MutDBLoc loc = {offs[name], ents.locs[i].index, ents.locs[i].key};
+		locs.push_back(loc);
+
+		pre_name = name;
+	}
+
+	MutDBHeader h;
+	memset(&h, 0, sizeof(h));
+	h.magic = ACCMUT_DB_MAGIC;
+	h.version = ACCMUT_DB_VERSION;
+	h.mut_num = ents.recs.size();
+	h.func_num = funcs.size();
+	h.rec_size = sizeof(MutDBRecord);
+	h.rec_off = sizeof(MutDBHeader);
+	h.loc_off = h.rec_off + sizeof(MutDBRecord) * h.mut_num;
+	h.func_off = h.loc_off + sizeof(MutDBLoc) * h.mut_num;
+	h.str_off = h.func_off + sizeof(MutDBFunc) * h.func_num;
+	h.str_size = strtab.size();
+
+	h.text_size = ents.text_size;
+	h.text_hash = ents.text_hash;
+
+	stringstream ss;
+	ss<<getDBPath()<<"."<<getpid();
+	string tmp = ss.str();
+
+	ofstream out(tmp.c_str(), ios::out | ios::binary | ios::trunc);
+	out.write((const char *)&h, sizeof(h));
+	if(!ents.recs.empty()){
+		out.write((const char *)&ents.recs[0], sizeof(MutDBRecord) * ents.recs.size());
+		out.write((const char *)&locs[0], sizeof(MutDBLoc) * locs.size());
+		out.write((const char *)&funcs[0], sizeof(MutDBFunc) * funcs.size());
+	}
+	out.write(strtab.data(), strtab.size());
+	out.close();
+
+	//readers never see a half written db
+	if(!out || rename(tmp.c_str(), getDBPath().c_str()) != 0){
+		unlink(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+void MutationDB::appendModule(const string &lines){
+	if(lines.empty()){
+		return;
+	}
+
+	//one write of O_APPEND, the lines of the compilers of a parallel make
+	//never interleave and none waits for the others, nor rewrites the db
+	int fd = ::open(getTextPath().c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+	if(fd < 0){
+		errs()<<"FILE ERROR : mutations.txt @ "<<getTextPath()<<"\n";
+		return;
+	}
+	const char *p = lines.data();
+	size_t left = lines.size();
+	while(left > 0){
+		ssize_t w = ::write(fd, p, left);
+		if(w < 0){
+			errs()<<"FILE ERROR : mutations.txt @ "<<getTextPath()<<"\n";
+			break;
+		}
+		p += w;
+		left -= w;
+	}
+	::close(fd);
+}
+
+string MutationDB::getShardDir(const string &module){
+	//sub1/util.c and sub2/util.c are both util.c when compiled in their directories
+	SmallString<256> abs(module);
+	sys::fs::make_absolute(abs);
+	string path = abs.str();
+
+	//the names sort like the modules, the hash tells apart the modules
+	//whose names are the same once the path separators are gone
+	string name;
+	unsigned hash = 2166136261u;
+	for(unsigned i = 0; i < path.size(); i++){
+		char c = path[i];
+		name.push_back(isalnum((unsigned char)c) || c == '.' || c == '-' || c == '_' ? c : '_');
+		hash ^= (unsigned char)c;
+		hash *= 16777619u;
+	}
+	char buf[16];
+	snprintf(buf, sizeof(buf), "-%08x", hash);
+
+	//a file name is at most 255 bytes, the hash keeps the full path
+	if(name.size() > 200){
+		name = name.substr(name.size() - 200);
+	}
+
+	string dir = getenv("HOME");
+	dir += "/tmp/accmut/shards/";
+	return dir + name + buf;
+}
+
+void MutationDB::writeShard(const string &module, const string &file, const string &content){
+	string dir = getShardDir(module);
+	string parent = dir.substr(0, dir.rfind('/'));
+	if((mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+		|| (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)){
+		errs()<<"FILE ERROR : shard @ "<<dir<<"\n";
+		return;
+	}
+
+	string path = dir + "/" + file;
+	stringstream ss;
+	ss<<path<<"."<<getpid();
+	string tmp = ss.str();
+
+	ofstream out(tmp.c_str(), ios::out | ios::trunc);
+	out<<content;
+	out.close();
+
+	//the merge never sees a half written shard
+	if(!out || rename(tmp.c_str(), path.c_str()) != 0){
+		unlink(tmp.c_str());
+		errs()<<"FILE ERROR : "<<file<<" @ "<<path<<"\n";
+	}
+}
@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Pass.h"
@@ -20,9 +21,15 @@
 
 #include "llvm/Transforms/AccMut/MutationGen.h"
 #include "llvm/Transforms/AccMut/MutUtil.h"
+#include "llvm/Transforms/AccMut/MutationDB.h"
+#include "llvm/Transforms/AccMut/MutationTCE.h"
+#include "llvm/Transforms/AccMut/MutationIncr.h"
+#include "llvm/Transforms/AccMut/MutationKey.h"
 
 #include <sstream>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 #define NEED_LOOP_INFO 0
@@ -31,11 +38,18 @@
 #include "llvm/Analysis/LoopInfo.h"
 #endif
 
+#if ACCMUT_GEN_MUT_KNOWN_BITS
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/ConstantRange.h"
+#include "llvm/InitializePasses.h"
+#endif
+
 
 using namespace llvm;
 using namespace std;
 
-ofstream  MutationGen::ofresult; 
+stringstream  MutationGen::ofresult; 
 
 
 #define ARITH_OP_NUM 7
@@ -47,15 +61,61 @@ static unsigned logic_opcodes[LOGIC_OP_NUM] = {Instruction::Shl, Instruction::LS
 	Instruction::Or, Instruction::Xor};
 
 MutationGen::MutationGen(Module *M) : FunctionPass(ID) {
-	string home = getenv("HOME");
-	stringstream ss;
-	ss<<home<<"/tmp/accmut/mutations.txt"; 
-	ofresult.open(ss.str(), ios::app); 
+	ofresult.str("");
 	this->TheModule = M;
+	#if ACCMUT_GEN_MUT_KNOWN_BITS
+	initializeScalarEvolutionWrapperPassPass(*PassRegistry::getPassRegistry());
+	#endif
 }
 
 static int muts_num = 0;
 
+#if ACCMUT_GEN_MUT_PRUNE
+static int pruned_num = 0;
+static int muts_total = 0;
+static int pruned_total = 0;
+#endif
+
+#if ACCMUT_GEN_MUT_KNOWN_BITS
+static ScalarEvolution *SE;
+static const DataLayout *DL;
+static int equiv_num = 0;
+static int equiv_total[Mutation::MK_ABV + 1];	// per operator
+#endif
+
+bool MutationGen::doFinalization(Module &M){
+	#if ACCMUT_GEN_MUT_SHARDS
+	MutationDB::writeShard(M.getModuleIdentifier(), "mutations.txt", ofresult.str());
+	#else
+	MutationDB::appendModule(ofresult.str());
+	#endif
+	ofresult.str("");
+
+	#if ACCMUT_GEN_MUT_TCE
+	MutationTCE::appendTable(M);
+	#endif
+
+	#if ACCMUT_GEN_MUT_INCREMENTAL
+	MutationIncr::appendTable(M);
+	#endif
+
+	#if ACCMUT_GEN_MUT_PRUNE
+	llvm::errs()<<"\n\t PRUNED "<<pruned_total<<" OF "<<(muts_total + pruned_total)<<" MUTS FOR : "
+		<<M.getName()<<", GEN "<<muts_total<<"\n";
+	muts_total = 0;
+	pruned_total = 0;
+	#endif
+
+	#if ACCMUT_GEN_MUT_KNOWN_BITS
+	llvm::errs()<<"\n\t EQUIVALENT MUTS DROPPED FOR : "<<M.getName()<<" -> LVR "<<equiv_total[Mutation::MK_LVR]
+		<<", UOI "<<equiv_total[Mutation::MK_UOI]<<", ABV "<<equiv_total[Mutation::MK_ABV]
+		<<", ROR "<<equiv_total[Mutation::MK_ROR]<<"\n";
+	memset(equiv_total, 0, sizeof(equiv_total));
+	#endif
+
+	return false;
+}
+
 #if NEED_LOOP_INFO
 static LoopInfo *LI;
 #endif
@@ -63,6 +123,9 @@ static LoopInfo *LI;
 bool MutationGen::runOnFunction(Function &F) {
 
 	muts_num = 0;
+	#if ACCMUT_GEN_MUT_PRUNE
+	pruned_num = 0;
+	#endif
 
 	//omit main function and the functions with "__accmut__" prefix
 	if(F.getName().startswith("__accmut__")){
@@ -73,13 +136,55 @@ bool MutationGen::runOnFunction(Function &F) {
 	}
 	llvm::errs()<<"\n\t GENEARTING MUTATION FOR : "<<TheModule->getName()<<" -> "<<F.getName()<<"() ";
 
+	#if ACCMUT_GEN_MUT_INCREMENTAL
+	string prev;
+	if(MutationIncr::getPrevious(F, MutationIncr::addFunction(F), prev)){
+		ofresult<<prev;
+		muts_num = count(prev.begin(), prev.end(), '\n');
+		llvm::errs()<<"\tUNCHANGED, REUSE "<<muts_num<<" MUTS\n";
+		return false;
+	}
+	#endif
+
 	#if NEED_LOOP_INFO
 	LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
 	#endif
 
+	#if ACCMUT_GEN_MUT_KNOWN_BITS
+	SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+	DL = &F.getParent()->getDataLayout();
+	equiv_num = 0;
+	#endif
+
+	size_t begin = ofresult.str().size();
+
 	genMutationFile(F);
 
+	string all = ofresult.str();
+	string kept = all.substr(begin);
+
+	#if ACCMUT_GEN_MUT_TCE
+	int dropped;
+	kept = MutationTCE::filter(F, kept, dropped);
+	muts_num -= dropped;
+	llvm::errs()<<"\tTCE DROPPED "<<dropped<<" MUTS\n";
+	#endif
+
+	//the stable keys, see MutationKey.h
+	ofresult.str("");
+	ofresult<<all.substr(0, begin)<<MutationKey::addKeys(F, kept);
+
+	#if ACCMUT_GEN_MUT_KNOWN_BITS
+	llvm::errs()<<"\tEQUIVALENT "<<equiv_num;
+	#endif
+
+	#if ACCMUT_GEN_MUT_PRUNE
+	llvm::errs()<<"\tGEN "<<muts_num<<" MUTS, PRUNED "<<pruned_num<<"\n";
+	muts_total += muts_num;
+	pruned_total += pruned_num;
+	#else
 	llvm::errs()<<"\tGEN "<<muts_num<<" MUTS\n";
+	#endif
 	return false;
 }
 
@@ -92,6 +197,333 @@ static bool isSupportedType(Type *t){
 	}
 }
 
+#if ACCMUT_GEN_MUT_PRUNE
+/*
+* With ACCMUT_GEN_MUT_PRUNE only the non-redundant mutants are generated.
+* A mutant is left out if another mutant of the same instruction computes the
+* same values, if it computes the values of the original (an equivalent
+* mutant), or if it is not a dominator in the subsumption graph of its
+* operator, i.e. every test that kills the dominators kills it as well.
+*  - ROR replaces a predicate only by its sufficient set (Kaminski et al.),
+*    e.g. a < b -> a <= b, a != b, false. The set keeps the signedness of the
+*    original, eq and ne count as signed. The constant predicates are
+*    FCMP_FALSE and FCMP_TRUE, which the runtime evaluates to 0 and 1.
+*  - ROV of an icmp is a ROR (a < b -> b < a is a > b), of and, or, xor or of
+*    two equal operands it is equivalent.
+*  - UOI and ABV of a constant T give an LVR value of T or T itself. UOI inc
+*    and dec of x in x + T, x - T and T - x are the LVR mutants T+1 and T-1.
+*  - AOR and LOR from an identity to an identity (x + 0 -> x - 0,
+*    x << 0 -> x | 0) are equivalent.
+*/
+
+static const unsigned short minimal_ror[CmpInst::LAST_ICMP_PREDICATE - CmpInst::FIRST_ICMP_PREDICATE + 1][3] = {
+	/* eq  */ {CmpInst::ICMP_SLE, CmpInst::ICMP_SGE, CmpInst::FCMP_FALSE},
+	/* ne  */ {CmpInst::ICMP_SLT, CmpInst::ICMP_SGT, CmpInst::FCMP_TRUE},
+	/* ugt */ {CmpInst::ICMP_UGE, CmpInst::ICMP_NE, CmpInst::FCMP_FALSE},
+	/* uge */ {CmpInst::ICMP_UGT, CmpInst::ICMP_EQ, CmpInst::FCMP_TRUE},
+	/* ult */ {CmpInst::ICMP_ULE, CmpInst::ICMP_NE, CmpInst::FCMP_FALSE},
+	/* ule */ {CmpInst::ICMP_ULT, CmpInst::ICMP_EQ, CmpInst::FCMP_TRUE},
+	/* sgt */ {CmpInst::ICMP_SGE, CmpInst::ICMP_NE, CmpInst::FCMP_FALSE},
+	/* sge */ {CmpInst::ICMP_SGT, CmpInst::ICMP_EQ, CmpInst::FCMP_TRUE},
+	/* slt */ {CmpInst::ICMP_SLE, CmpInst::ICMP_NE, CmpInst::FCMP_FALSE},
+	/* sle */ {CmpInst::ICMP_SLT, CmpInst::ICMP_EQ, CmpInst::FCMP_TRUE}
+};
+
+// whether genLVR replaces CI by v
+static bool isLVRTarget(const ConstantInt *CI, const APInt &v){
+	int64_t targets[5];
+	int num = 0;
+	if(CI->isZero()){
+		targets[num++] = 1;
+		targets[num++] = -1;
+	}else if(CI->isOne()){
+		targets[num++] = 0;
+		targets[num++] = -1;
+		targets[num++] = 2;
+	}else if(CI->isMinusOne()){
+		targets[num++] = 0;
+		targets[num++] = 1;
+		targets[num++] = -2;
+	}else if(CI->equalsInt((unsigned) -2)){
+		targets[num++] = 0;
+		targets[num++] = 1;
+		targets[num++] = -1;
+		targets[num++] = -3;
+	}else if(CI->equalsInt(2)){
+		targets[num++] = 0;
+		targets[num++] = 1;
+		targets[num++] = -1;
+		targets[num++] = 3;
+	}else{
+		// genLVR computes T+1 and T-1 in int
+		int64_t low = (int)*(CI->getValue().getRawData());
+		targets[num++] = 0;
+		targets[num++] = 1;
+		targets[num++] = -1;
+		targets[num++] = (int)(low + 1);
+		targets[num++] = (int)(low - 1);
+	}
+	for(int i = 0; i < num; i++){
+		if(APInt(v.getBitWidth(), targets[i], true) == v){
+			return true;
+		}
+	}
+	return false;
+}
+
+// tp: 0 inc, 1 dec, 2 neg
+static bool isRedundantUOI(Instruction *inst, unsigned op, int tp){
+	if(const ConstantInt *CI = dyn_cast<ConstantInt>(inst->getOperand(op))){
+		const APInt &t = CI->getValue();
+		APInt v = tp == 0 ? t + 1 : (tp == 1 ? t - 1 : -t);
+		return v == t || isLVRTarget(CI, v);
+	}
+	unsigned opc = inst->getOpcode();
+	if((opc == Instruction::Add || opc == Instruction::Sub) && tp != 2){
+		const ConstantInt *CI = dyn_cast<ConstantInt>(inst->getOperand(1 - op));
+		if(CI == NULL){
+			return false;
+		}
+		// x + T -> (x+1) + T is x + (T+1), x - T -> (x+1) - T is x - (T-1)
+		bool up = (tp == 0) == (opc == Instruction::Add);
+		return isLVRTarget(CI, up ? CI->getValue() + 1 : CI->getValue() - 1);
+	}
+	return false;
+}
+
+static bool isRedundantABV(Instruction *inst, unsigned op){
+	if(const ConstantInt *CI = dyn_cast<ConstantInt>(inst->getOperand(op))){
+		const APInt &t = CI->getValue();
+		APInt v = t.isNegative() ? -t : t;
+		return v == t || isLVRTarget(CI, v);
+	}
+	return false;
+}
+
+static bool isRedundantROV(Instruction *inst, unsigned i, unsigned j){
+	unsigned opc = inst->getOpcode();
+	if(opc == Instruction::ICmp || opc == Instruction::And || opc == Instruction::Or
+		|| opc == Instruction::Xor){
+		return true;
+	}
+	return inst->getOperand(i) == inst->getOperand(j);
+}
+
+// whether x OPC C is x
+static bool isIdentity(unsigned opc, const ConstantInt *C){
+	switch(opc){
+		case Instruction::Add:
+		case Instruction::Sub:
+		case Instruction::Shl:
+		case Instruction::LShr:
+		case Instruction::AShr:
+		case Instruction::Or:
+		case Instruction::Xor:
+			return C->isZero();
+		case Instruction::Mul:
+		case Instruction::UDiv:
+		case Instruction::SDiv:
+			return C->isOne();
+		case Instruction::And:
+			return C->isMinusOne();
+		default:
+			return false;
+	}
+}
+
+// for AOR and LOR
+static bool isEquivalentOpcode(Instruction *inst, unsigned opc){
+	const ConstantInt *C = dyn_cast<ConstantInt>(inst->getOperand(1));
+	return C != NULL && isIdentity(inst->getOpcode(), C) && isIdentity(opc, C);
+}
+#endif
+
+#if ACCMUT_GEN_MUT_KNOWN_BITS
+/*
+* With ACCMUT_GEN_MUT_KNOWN_BITS the mutants that are provably equivalent on
+* all inputs are not generated. The facts come from computeKnownBits of
+* ValueTracking and from the ranges and predicates of ScalarEvolution:
+*  - ABV of a value that is known non-negative.
+*  - UOI inc and dec, and LVR, of an operand of and, or, lshr and ashr if
+*    the bits they change are masked out: (x + 1) & ~1 with x known even.
+*  - UOI, ABV and LVR of an operand of an icmp, and ROR, if the result of
+*    the icmp is known and stays the same.
+*  - ROR between < and <= (eq and false, ...) if the operands are known
+*    unequal, between a signed and an unsigned predicate if both are known
+*    non-negative.
+*/
+
+static void getKnownBits(Value *V, Instruction *CxtI, APInt &zero, APInt &one){
+	unsigned w = V->getType()->getIntegerBitWidth();
+	zero = APInt(w, 0);
+	one = APInt(w, 0);
+	computeKnownBits(V, zero, one, *DL, 0, nullptr, CxtI);
+	if(SE->isSCEVable(V->getType())){
+		ConstantRange r = SE->getUnsignedRange(SE->getSCEV(V));
+		zero |= APInt::getHighBitsSet(w, r.getUnsignedMax().countLeadingZeros());
+	}
+}
+
+static bool isNonNegative(Value *V, Instruction *CxtI){
+	if(isKnownNonNegative(V, *DL, 0, nullptr, CxtI)){
+		return true;
+	}
+	return SE->isSCEVable(V->getType()) && SE->isKnownNonNegative(SE->getSCEV(V));
+}
+
+// the bits inc (tp 0) or dec (tp 1) of V can change, all if they are not known
+static APInt getUOIChangedBits(Value *V, Instruction *CxtI, int tp){
+	APInt zero, one;
+	getKnownBits(V, CxtI, zero, one);
+	unsigned w = zero.getBitWidth();
+	// inc flips the trailing ones and the zero above them, dec the other way
+	const APInt &run = tp == 0 ? one : zero;
+	const APInt &stop = tp == 0 ? zero : one;
+	unsigned t = run.countTrailingOnes();
+	if(tp > 1 || t >= w || !stop[t]){
+		return APInt::getAllOnesValue(w);
+	}
+	return APInt::getLowBitsSet(w, t + 1);
+}
+
+// whether changing the bits changed of operand op does not change inst
+static bool isMaskedOut(Instruction *inst, unsigned op, const APInt &changed){
+	unsigned w = changed.getBitWidth();
+	switch(inst->getOpcode()){
+		case Instruction::And:
+		case Instruction::Or:{
+			APInt zero, one;
+			getKnownBits(inst->getOperand(1 - op), inst, zero, one);
+			const APInt &fixed = inst->getOpcode() == Instruction::And ? zero : one;
+			return (changed & ~fixed) == 0;
+		}
+		case Instruction::LShr:
+		case Instruction::AShr:{
+			const ConstantInt *s = dyn_cast<ConstantInt>(inst->getOperand(1));
+			return op == 0 && s != NULL && s->getValue().ult(w) && changed.getActiveBits() <= s->getZExtValue();
+		}
+		default:
+			return false;
+	}
+}
+
+// 1 if pre a, b always holds, 0 if it never holds, -1 if it is not known
+static int getKnownICmp(unsigned pre, const SCEV *a, const SCEV *b){
+	if(pre == CmpInst::FCMP_FALSE || pre == CmpInst::FCMP_TRUE){
+		return pre == CmpInst::FCMP_TRUE;
+	}
+	if(SE->isKnownPredicate((CmpInst::Predicate) pre, a, b)){
+		return 1;
+	}
+	if(SE->isKnownPredicate(CmpInst::getInversePredicate((CmpInst::Predicate) pre), a, b)){
+		return 0;
+	}
+	return -1;
+}
+
+// whether the icmp gives the same known result with pre, a, b
+static bool isSameICmp(Instruction *inst, unsigned pre, const SCEV *a, const SCEV *b){
+	ICmpInst *CI = cast<ICmpInst>(inst);
+	int ori = getKnownICmp(CI->getPredicate(), SE->getSCEV(CI->getOperand(0)), SE->getSCEV(CI->getOperand(1)));
+	return ori >= 0 && ori == getKnownICmp(pre, a, b);
+}
+
+// whether the icmp gives the same known result with operand op replaced by v
+static bool isSameICmp(Instruction *inst, unsigned op, const SCEV *v){
+	ICmpInst *CI = cast<ICmpInst>(inst);
+	const SCEV *a = op == 0 ? v : SE->getSCEV(CI->getOperand(0));
+	const SCEV *b = op == 1 ? v : SE->getSCEV(CI->getOperand(1));
+	return isSameICmp(inst, CI->getPredicate(), a, b);
+}
+
+static unsigned getCanonicalPredicate(unsigned pre, bool unequal, bool nonneg){
+	if(nonneg && CmpInst::isSigned(pre)){
+		pre = ICmpInst::getUnsignedPredicate((CmpInst::Predicate) pre);
+	}
+	if(!unequal){
+		return pre;
+	}
+	switch(pre){
+		case CmpInst::ICMP_EQ: return CmpInst::FCMP_FALSE;
+		case CmpInst::ICMP_NE: return CmpInst::FCMP_TRUE;
+		case CmpInst::ICMP_ULE: return CmpInst::ICMP_ULT;
+		case CmpInst::ICMP_UGE: return CmpInst::ICMP_UGT;
+		case CmpInst::ICMP_SLE: return CmpInst::ICMP_SLT;
+		case CmpInst::ICMP_SGE: return CmpInst::ICMP_SGT;
+		default: return pre;
+	}
+}
+
+static bool isEquivalentROR(Instruction *inst, unsigned pre){
+	ICmpInst *CI = cast<ICmpInst>(inst);
+	Value *a = CI->getOperand(0), *b = CI->getOperand(1);
+	const SCEV *sa = SE->getSCEV(a), *sb = SE->getSCEV(b);
+	if(isSameICmp(inst, pre, sa, sb)){
+		return true;
+	}
+	APInt za, oa, zb, ob;
+	getKnownBits(a, inst, za, oa);
+	getKnownBits(b, inst, zb, ob);
+	bool unequal = ((za & ob) | (oa & zb)) != 0 || SE->isKnownPredicate(CmpInst::ICMP_NE, sa, sb);
+	bool nonneg = isNonNegative(a, inst) && isNonNegative(b, inst);
+	return getCanonicalPredicate(CI->getPredicate(), unequal, nonneg) == getCanonicalPredicate(pre, unequal, nonneg);
+}
+
+// tp: 0 inc, 1 dec, 2 neg
+static bool isEquivalentUOI(Instruction *inst, unsigned op, int tp){
+	Value *V = inst->getOperand(op);
+	if(isa<ICmpInst>(inst)){
+		const SCEV *x = SE->getSCEV(V);
+		const SCEV *one = SE->getConstant(V->getType(), 1);
+		const SCEV *v = tp == 0 ? SE->getAddExpr(x, one) : (tp == 1 ? SE->getMinusSCEV(x, one) : SE->getNegativeSCEV(x));
+		return isSameICmp(inst, op, v);
+	}
+	return isMaskedOut(inst, op, getUOIChangedBits(V, inst, tp));
+}
+
+static bool isEquivalentABV(Instruction *inst, unsigned op){
+	Value *V = inst->getOperand(op);
+	if(isNonNegative(V, inst)){
+		return true;
+	}
+	if(isa<ICmpInst>(inst)){
+		// abs(x) is smax(x, -x), also for the smallest value
+		const SCEV *x = SE->getSCEV(V);
+		return isSameICmp(inst, op, SE->getSMaxExpr(x, SE->getNegativeSCEV(x)));
+	}
+	return false;
+}
+
+static bool isEquivalentLVR(Instruction *inst, unsigned op, int64_t target){
+	const ConstantInt *CI = cast<ConstantInt>(inst->getOperand(op));
+	APInt v(CI->getBitWidth(), target, true);
+	if(isa<ICmpInst>(inst)){
+		return isSameICmp(inst, op, SE->getConstant(v));
+	}
+	return isMaskedOut(inst, op, CI->getValue() ^ v);
+}
+
+// the lines of genLVR for operand op without the equivalent ones
+static string dropEquivalentLVR(Instruction *inst, unsigned op, const string &lines){
+	if(!inst->getOperand(op)->getType()->isIntegerTy(32) && !inst->getOperand(op)->getType()->isIntegerTy(64)){
+		return lines;
+	}
+	stringstream in(lines), kept;
+	string line;
+	while(getline(in, line)){
+		int64_t target = strtoll(line.c_str() + line.rfind(':') + 1, NULL, 10);
+		if(isEquivalentLVR(inst, op, target)){
+			equiv_num++;
+			equiv_total[Mutation::MK_LVR]++;
+			muts_num--;
+			continue;
+		}
+		kept<<line<<'\n';
+	}
+	return kept.str();
+}
+#endif
+
 void MutationGen::genMutationFile(Function & F){
 	int index = 0;
 	
@@ -235,7 +667,6 @@ void MutationGen::genMutationFile(Function & F){
 			
 		}
 	}
-	ofresult.flush();
 }
 
 void MutationGen::genAOR(Instruction *inst, StringRef fname, int index){
@@ -243,11 +674,16 @@ void MutationGen::genAOR(Instruction *inst, StringRef fname, int index){
 		if(arith_opcodes[i] == inst->getOpcode()){
 			continue;
 		}
+		#if ACCMUT_GEN_MUT_PRUNE
+		if(isEquivalentOpcode(inst, arith_opcodes[i])){
+			pruned_num++;
+			continue;
+		}
+		#endif
 		std::stringstream ss;
 		ss<<"AOR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()
 			<< ":"<<arith_opcodes[i]<<'\n';
 		ofresult<<ss.str();
-		ofresult.flush();		
 		muts_num++;
 	}
 }
@@ -277,17 +713,42 @@ void MutationGen::genROR(Instruction *inst,StringRef fname, int index){
 			muts_num++;
 		}						
 	}else{
+		#if ACCMUT_GEN_MUT_PRUNE
+		const unsigned short *minimal = minimal_ror[predicate - CmpInst::FIRST_ICMP_PREDICATE];
+		for(int i = 0; i < 3; i++){
+			#if ACCMUT_GEN_MUT_KNOWN_BITS
+			if(isEquivalentROR(inst, minimal[i])){
+				equiv_num++;
+				equiv_total[Mutation::MK_ROR]++;
+				continue;
+			}
+			#endif
+			std::stringstream ss;
+			ss<<"ROR:"<<std::string(fname)<<":"<<index<<":"
+				<<inst->getOpcode()<<":"<<predicate<<":"<<minimal[i]<<'\n';
+			ofresult<<ss.str();
+			muts_num++;
+		}
+		pruned_num += CmpInst::LAST_ICMP_PREDICATE - CmpInst::FIRST_ICMP_PREDICATE - 3;
+		#else
 		for(unsigned short i = CmpInst::FIRST_ICMP_PREDICATE; i <= CmpInst::LAST_ICMP_PREDICATE; i++){
 			if(i == predicate)
 				continue;
+			#if ACCMUT_GEN_MUT_KNOWN_BITS
+			if(isEquivalentROR(inst, i)){
+				equiv_num++;
+				equiv_total[Mutation::MK_ROR]++;
+				continue;
+			}
+			#endif
 			std::stringstream ss;
 			ss<<"ROR:"<<std::string(fname)<<":"<<index<<":"
 				<<inst->getOpcode()<<":"<<predicate<<":"<<i<<'\n';
 			ofresult<<ss.str();
 			muts_num++;
 		}
+		#endif
 	}
-	ofresult.flush();
 }
 
 void MutationGen::genLOR(Instruction *inst, StringRef fname, int index){
@@ -295,11 +756,16 @@ void MutationGen::genLOR(Instruction *inst, StringRef fname, int index){
 		if(logic_opcodes[i] == inst->getOpcode()){
 			continue;
 		}
+		#if ACCMUT_GEN_MUT_PRUNE
+		if(isEquivalentOpcode(inst, logic_opcodes[i])){
+			pruned_num++;
+			continue;
+		}
+		#endif
 		std::stringstream ss;
 		ss<<"LOR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()
 			<< ":"<<logic_opcodes[i]<<'\n';
 		ofresult<<ss.str();
-		ofresult.flush();
 		muts_num++;
 	}	
 }
@@ -343,7 +809,6 @@ void MutationGen::genSTDCall(Instruction * inst, StringRef fname, int index){
 		muts_num++;
 		
 		ofresult<<ss.str();
-		ofresult.flush();
 	}else if(tt->isVoidTy()){
 		//2. if the func returns void, subsitute @llvm.donothing for the func
 		//errs()<<"IT IS A VOID !!\n";
@@ -351,7 +816,6 @@ void MutationGen::genSTDCall(Instruction * inst, StringRef fname, int index){
 		ss<<"STD:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()
 			<< ":"<<0<<'\n';
 		ofresult<<ss.str();
-		ofresult.flush();
 		muts_num++;
 	}else if(tt->isIntegerTy(64)){
 		//1. if the func returns a int64 val, let it be 0, 1 or a random number
@@ -375,7 +839,6 @@ void MutationGen::genSTDCall(Instruction * inst, StringRef fname, int index){
 		muts_num++;
 		
 		ofresult<<ss.str();	
-		ofresult.flush();
 	}
 	
 }
@@ -388,7 +851,6 @@ void MutationGen::genSTDStore(Instruction * inst, StringRef fname, int index){
 		ss<<"STD:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()
 			<< ":"<<0<<'\n';
 		ofresult<<ss.str();
-		ofresult.flush();
 		muts_num++;
 	}
 }
@@ -414,7 +876,6 @@ void MutationGen::genLVR(Instruction *inst, StringRef fname, int index){
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<":"<<0<<":"<<-1<<'\n';
 					muts_num++;
-					ofresult<<ss.str();
 				}else if(CI->isOne()){
 					// 1 -> 0
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
@@ -428,7 +889,6 @@ void MutationGen::genLVR(Instruction *inst, StringRef fname, int index){
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<":"<<1<<":"<<2<<'\n';
 					muts_num++;
-					ofresult<<ss.str();		
 				}else if(CI->isMinusOne()){
 					// -1 -> 0
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
@@ -442,7 +902,6 @@ void MutationGen::genLVR(Instruction *inst, StringRef fname, int index){
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<":"<<-1<<":"<<-2<<'\n';
 					muts_num++;
-					ofresult<<ss.str();		
 				}else if(CI->equalsInt((unsigned) -2)){
 					// -2 -> 0
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
@@ -460,7 +919,6 @@ void MutationGen::genLVR(Instruction *inst, StringRef fname, int index){
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<":"<<-2<<":"<<-3<<'\n';
 					muts_num++;
-					ofresult<<ss.str();						
 				}else if(CI->equalsInt(2)){
 					// 2 -> 0
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
@@ -478,7 +936,6 @@ void MutationGen::genLVR(Instruction *inst, StringRef fname, int index){
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<":"<<2<<":"<<3<<'\n';
 					muts_num++;
-					ofresult<<ss.str();						
 				}else{
 				// T -> 0
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
@@ -502,9 +959,12 @@ void MutationGen::genLVR(Instruction *inst, StringRef fname, int index){
 					ss<<"LVR:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<":"<<CI->getValue().toString(10, true)<<":"<<smaller<<'\n';
 					muts_num++;
-					ofresult<<ss.str();	
 				}
-				ofresult.flush();
+				#if ACCMUT_GEN_MUT_KNOWN_BITS
+				ofresult<<dropEquivalentLVR(inst, i, ss.str());
+				#else
+				ofresult<<ss.str();
+				#endif
 		}
 
 	}
@@ -528,22 +988,28 @@ void MutationGen::genUOI(Instruction *inst, StringRef fname, int index){
 		*/
 		
 		std::stringstream ss;
-		ss<<"UOI:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
-			<<i<<":"<<"0\n";	//inc
-		muts_num++;
-
-		ss<<"UOI:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
-			<<i<<":"<<"1\n";	//dec
-		muts_num++;
-		
-		ss<<"UOI:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
-			<<i<<":"<<"2\n";	//neg
-		muts_num++;
+		for(int tp = 0; tp < 3; tp++){	//inc, dec, neg
+			#if ACCMUT_GEN_MUT_PRUNE
+			if(isRedundantUOI(inst, i, tp)){
+				pruned_num++;
+				continue;
+			}
+			#endif
+			#if ACCMUT_GEN_MUT_KNOWN_BITS
+			if(isEquivalentUOI(inst, i, tp)){
+				equiv_num++;
+				equiv_total[Mutation::MK_UOI]++;
+				continue;
+			}
+			#endif
+			ss<<"UOI:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
+				<<i<<":"<<tp<<"\n";
+			muts_num++;
+		}
 		
 		ofresult<<ss.str();	
 		
 	}	
-	ofresult.flush();
 }
 
 void MutationGen::genROV(Instruction *inst, StringRef fname, int index){
@@ -614,6 +1080,13 @@ void MutationGen::genROV(Instruction *inst, StringRef fname, int index){
 				continue;
 			}
 
+			#if ACCMUT_GEN_MUT_PRUNE
+			if(isRedundantROV(inst, i, j)){
+				pruned_num++;
+				continue;
+			}
+			#endif
+
 			std::stringstream ss;
 			ss<<"ROV:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 				<<i<<":"<<j<<"\n";
@@ -621,7 +1094,6 @@ void MutationGen::genROV(Instruction *inst, StringRef fname, int index){
 			muts_num++;
 		}
 	}	
-	ofresult.flush();
 }
 
 void MutationGen::genABV(Instruction *inst, StringRef fname, int index){
@@ -629,6 +1101,19 @@ void MutationGen::genABV(Instruction *inst, StringRef fname, int index){
 	for(unsigned i = 0; i < inst->getNumOperands(); i++){
 		Type* t = inst->getOperand(i)->getType();
 		if( isSupportedType(t) ){
+			#if ACCMUT_GEN_MUT_PRUNE
+			if(isRedundantABV(inst, i)){
+				pruned_num++;
+				continue;
+			}
+			#endif
+			#if ACCMUT_GEN_MUT_KNOWN_BITS
+			if(isEquivalentABV(inst, i)){
+				equiv_num++;
+				equiv_total[Mutation::MK_ABV]++;
+				continue;
+			}
+			#endif
 			std::stringstream ss;
 			ss<<"ABV:"<<std::string(fname)<<":"<<index<< ":"<<inst->getOpcode()<<":"
 						<<i<<"\n";
@@ -636,7 +1121,6 @@ void MutationGen::genABV(Instruction *inst, StringRef fname, int index){
 			muts_num++;
 		}
 	}	
-	ofresult.flush();	
 }
 
 
@@ -649,6 +1133,10 @@ void MutationGen::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequiredTransitive<LoopInfoWrapperPass>();
 #endif
 
+#if ACCMUT_GEN_MUT_KNOWN_BITS
+  AU.addRequired<ScalarEvolutionWrapperPass>();
+#endif
+
 }
 
 char MutationGen::ID = 0;
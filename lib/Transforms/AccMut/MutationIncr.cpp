@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+// This file implements the incremental generation of the mutation generator
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "llvm/Transforms/AccMut/MutationIncr.h"
+#include "llvm/Transforms/AccMut/MutationTCE.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/MD5.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <vector>
+
+using namespace llvm;
+using namespace std;
+
+stringstream MutationIncr::table;
+bool MutationIncr::prevLoaded = false;
+map<string, string> MutationIncr::prevHashes;
+map<string, string> MutationIncr::prevLines;
+
+static string getAttrString(AttributeSet AS){
+	string res;
+	for(unsigned i = 0; i < AS.getNumSlots(); i++){
+		res += AS.getSlotAttributes(i).getAsString(AS.getSlotIndex(i));
+		res += ";";
+	}
+	return res;
+}
+
+string MutationIncr::addFunction(Function &F){
+	Function *copy = MutationTCE::copyFunction(F);
+
+	//the attribute groups and the metadata are numbered in the whole module,
+	//so they are hashed by their text
+	string attrs = getAttrString(F.getAttributes());
+	copy->setAttributes(AttributeSet());
+
+	set<string> seen;
+	vector<string> callees;
+	for(inst_iterator it = inst_begin(copy), E = inst_end(copy); it != E; ++it){
+		Instruction *I = &*it;
+
+		SmallVector<pair<unsigned, MDNode *>, 4> MDs;
+		I->getAllMetadata(MDs);
+		for(unsigned i = 0; i < MDs.size(); i++){
+			I->setMetadata(MDs[i].first, NULL);
+		}
+
+		CallSite CS(I);
+		if(!CS){
+			continue;
+		}
+		attrs += getAttrString(CS.getAttributes());
+		CS.setAttributes(AttributeSet());
+
+		Function *callee = dyn_cast<Function>(CS.getCalledValue()->stripPointerCasts());
+		if(callee == NULL || callee->isIntrinsic() || callee->getName().startswith("__accmut__")){
+			continue;
+		}
+		if(seen.insert(callee->getName()).second){
+			callees.push_back(callee->getName());
+		}
+	}
+
+	string hash = MutationTCE::hashFunction(copy);
+	copy->eraseFromParent();
+
+	MD5 md5;
+	md5.update(hash);
+	md5.update(attrs);
+	MD5::MD5Result res;
+	md5.final(res);
+	SmallString<32> digest;
+	MD5::stringifyResult(res, digest);
+
+	table<<F.getName().str()<<" "<<digest.str().str()<<" ";
+	if(callees.empty()){
+		table<<"-";
+	}
+	for(unsigned i = 0; i < callees.size(); i++){
+		table<<(i > 0 ? "," : "")<<callees[i];
+	}
+	table<<"\n";
+	return digest.str();
+}
+
+void MutationIncr::loadPrevious(){
+	prevLoaded = true;
+
+	string dir = getenv("HOME");
+	dir += "/tmp/accmut/prev/";
+
+	ifstream hin((dir + "funchash.txt").c_str());
+	string func, hash, callees;
+	while(hin>>func>>hash>>callees){
+		prevHashes[func] = hash;
+	}
+
+	ifstream min((dir + "mutations.txt").c_str());
+	string line;
+	while(getline(min, line)){
+		//TYPE:FUNC:INDEX:...
+		size_t b = line.find(':');
+		size_t e = b == string::npos ? b : line.find(':', b + 1);
+		if(e == string::npos){
+			continue;
+		}
+		prevLines[line.substr(b + 1, e - b - 1)] += line + "\n";
+	}
+}
+
+bool MutationIncr::getPrevious(Function &F, const string &hash, string &lines){
+	if(!prevLoaded){
+		loadPrevious();
+	}
+	map<string, string>::iterator found = prevHashes.find(F.getName());
+	if(found == prevHashes.end() || found->second != hash){
+		return false;
+	}
+	lines = prevLines[F.getName()];
+	return true;
+}
+
+void MutationIncr::appendTable(Module &M){
+	#if ACCMUT_GEN_MUT_SHARDS
+	MutationDB::writeShard(M.getModuleIdentifier(), "funchash.txt", table.str());
+	table.str("");
+	return;
+	#endif
+
+	if(table.str().empty()){
+		return;
+	}
+	string path = getenv("HOME");
+	path += "/tmp/accmut/funchash.txt";
+	ofstream out(path.c_str(), ios::app);
+	if(!out){
+		errs()<<"FILE ERROR : funchash.txt @ "<<path<<"\n";
+	}
+	out<<table.str();
+	table.str("");
+}
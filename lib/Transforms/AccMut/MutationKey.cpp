@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+// This file implements the stable keys of the mutants
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "llvm/Transforms/AccMut/MutationKey.h"
+#include "llvm/Transforms/AccMut/MutationDB.h"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace llvm;
+using namespace std;
+
+#define FNV_BASIS 0xcbf29ce484222325UL
+
+static unsigned long fnv(const string &s, unsigned long h = FNV_BASIS){
+	for(unsigned i = 0; i < s.size(); i++){
+		h ^= (unsigned char)s[i];
+		h *= 0x100000001b3UL;
+	}
+	return h;
+}
+
+unsigned long MutationKey::hashBlock(BasicBlock *BB){
+	string s;
+	for(BasicBlock::iterator I = BB->begin(); I != BB->end(); ++I){
+		s += I->getOpcodeName();
+		s += ";";
+	}
+	return fnv(s);
+}
+
+unsigned long MutationKey::hashInst(Instruction *I){
+	string s;
+	raw_string_ostream os(s);
+	os<<I->getOpcodeName()<<" ";
+	I->getType()->print(os);
+	if(CmpInst *CI = dyn_cast<CmpInst>(I)){
+		os<<" p"<<CI->getPredicate();
+	}
+	//the operands by what they are, not by where they are
+	for(unsigned i = 0; i < I->getNumOperands(); i++){
+		Value *V = I->getOperand(i);
+		os<<", ";
+		if(Argument *A = dyn_cast<Argument>(V)){
+			os<<"a"<<A->getArgNo();
+		}else if(Instruction *D = dyn_cast<Instruction>(V)){
+			os<<"i"<<D->getOpcodeName();
+		}else if(isa<BasicBlock>(V)){
+			os<<"b";
+		}else if(isa<Constant>(V)){
+			V->printAsOperand(os, true);
+		}else{
+			os<<"v";
+		}
+	}
+	os.flush();
+	return fnv(s);
+}
+
+string MutationKey::addKeys(Function &F, const string &lines){
+	vector<Instruction *> insts;
+	vector<unsigned long> blocks;
+	for(Function::iterator BB = F.begin(); BB != F.end(); ++BB){
+		unsigned long bh = hashBlock(&*BB);
+		for(BasicBlock::iterator I = BB->begin(); I != BB->end(); ++I){
+			insts.push_back(&*I);
+			blocks.push_back(bh);
+		}
+	}
+
+	set<unsigned long> used;
+	stringstream out;
+	stringstream in(lines);
+	string line;
+	while(getline(in, line)){
+		MutDBRecord rec;
+		string func;
+		int index;
+		//TYPE:FUNC:INDEX:PARAMS, the key leaves INDEX out
+		size_t params = line.find(':', line.find(':', line.find(':') + 1) + 1);
+		if(!MutationDB::parseLine(line, rec, func, index) || params == string::npos
+			|| (unsigned)abs(index) >= insts.size()){
+			out<<line<<'\n';
+			continue;
+		}
+
+		char buf[64];
+		snprintf(buf, sizeof(buf), "|%016lx|%016lx|", blocks[abs(index)], hashInst(insts[abs(index)]));
+		unsigned long key = fnv(func + buf + line.substr(0, 3) + line.substr(params));
+		while(!used.insert(key).second){
+			key = fnv("#", key);
+		}
+
+		snprintf(buf, sizeof(buf), " #%016lx", key);
+		out<<line<<buf<<'\n';
+	}
+	return out.str();
+}
@@ -0,0 +1,282 @@
+//===----------------------------------------------------------------------===//
+//
+// This file implements the trivial compiler equivalence (TCE) filter of the
+// mutation generator
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "llvm/Transforms/AccMut/MutationTCE.h"
+#include "llvm/Transforms/AccMut/Mutation.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+using namespace llvm;
+using namespace std;
+
+stringstream MutationTCE::table;
+
+string MutationTCE::filter(Function &F, const string &lines, int &dropped){
+	dropped = 0;
+	if(lines.empty()){
+		return lines;
+	}
+
+	//the scalar function passes of -O2 in PassManagerBuilder, without the loop passes
+	legacy::FunctionPassManager FPM(F.getParent());
+	FPM.add(createSROAPass());
+	FPM.add(createEarlyCSEPass());
+	FPM.add(createJumpThreadingPass());
+	FPM.add(createCorrelatedValuePropagationPass());
+	FPM.add(createCFGSimplificationPass());
+	FPM.add(createInstructionCombiningPass());
+	FPM.add(createReassociatePass());
+	FPM.add(createMergedLoadStoreMotionPass());
+	FPM.add(createGVNPass());
+	FPM.add(createMemCpyOptPass());
+	FPM.add(createSCCPPass());
+	FPM.add(createBitTrackingDCEPass());
+	FPM.add(createInstructionCombiningPass());
+	FPM.add(createJumpThreadingPass());
+	FPM.add(createCorrelatedValuePropagationPass());
+	FPM.add(createDeadStoreEliminationPass());
+	FPM.add(createAggressiveDCEPass());
+	FPM.add(createCFGSimplificationPass());
+	FPM.add(createInstructionCombiningPass());
+	FPM.doInitialization();
+
+	//digest -> the first line with it, "" for the original
+	map<string, string> seen;
+
+	Function *copy = copyFunction(F);
+	seen[getDigest(copy, FPM)] = "";
+	copy->eraseFromParent();
+
+	stringstream kept;
+	stringstream in(lines);
+	string line;
+	while(getline(in, line)){
+		MutDBRecord rec;
+		string func;
+		int index;
+		if(!MutationDB::parseLine(line, rec, func, index)){
+			kept<<line<<'\n';
+			continue;
+		}
+
+		//the index counts the debug intrinsics, they go after the mutation
+		copy = copyFunction(F, true);
+		Instruction *I = NULL;
+		int cur = 0;
+		for(inst_iterator it = inst_begin(copy), E = inst_end(copy); it != E; ++it, cur++){
+			if(cur == index){
+				I = &*it;
+				break;
+			}
+		}
+		//a mutant that can not be applied is kept
+		if(I == NULL || !applyMutation(I, rec) || verifyFunction(*copy)){
+			copy->eraseFromParent();
+			kept<<line<<'\n';
+			continue;
+		}
+		stripDebugInfo(copy);
+
+		string digest = getDigest(copy, FPM);
+		copy->eraseFromParent();
+
+		map<string, string>::iterator found = seen.find(digest);
+		if(found == seen.end()){
+			seen[digest] = line;
+			kept<<line<<'\n';
+			continue;
+		}
+		if(found->second.empty()){
+			table<<"EQ "<<line<<'\n';
+		}else{
+			table<<"DUP "<<line<<" "<<found->second<<'\n';
+		}
+		dropped++;
+	}
+
+	FPM.doFinalization();
+	return kept.str();
+}
+
+void MutationTCE::appendTable(Module &M){
+	#if ACCMUT_GEN_MUT_SHARDS
+	MutationDB::writeShard(M.getModuleIdentifier(), "tce.txt", table.str());
+	table.str("");
+	return;
+	#endif
+
+	if(table.str().empty()){
+		return;
+	}
+	string path = getenv("HOME");
+	path += "/tmp/accmut/tce.txt";
+	ofstream out(path.c_str(), ios::app);
+	if(!out){
+		errs()<<"FILE ERROR : tce.txt @ "<<path<<"\n";
+	}
+	out<<table.str();
+	table.str("");
+}
+
+Function *MutationTCE::copyFunction(Function &F, bool keepDebug){
+	ValueToValueMapTy VMap;
+	Function *copy = CloneFunction(&F, VMap, false);
+	copy->setLinkage(GlobalValue::InternalLinkage);
+	copy->setComdat(nullptr);
+	copy->removeFnAttr(Attribute::OptimizeNone);
+	F.getParent()->getFunctionList().push_back(copy);
+	copy->setName("__accmut__tce");
+
+	if(!keepDebug){
+		stripDebugInfo(copy);
+	}
+	return copy;
+}
+
+void MutationTCE::stripDebugInfo(Function *copy){
+	//the debug info would only tell the copies apart
+	for(inst_iterator it = inst_begin(copy), E = inst_end(copy); it != E; ){
+		Instruction *I = &*it++;
+		if(isa<DbgInfoIntrinsic>(I)){
+			I->eraseFromParent();
+			continue;
+		}
+		I->setDebugLoc(DebugLoc());
+	}
+}
+
+bool MutationTCE::applyMutation(Instruction *I, const MutDBRecord &rec){
+	switch(rec.type){
+		case Mutation::MK_AOR:
+		case Mutation::MK_LOR:{
+			if(!isa<BinaryOperator>(I)){
+				return false;
+			}
+			Instruction *N = BinaryOperator::Create((Instruction::BinaryOps) rec.op_0,
+				I->getOperand(0), I->getOperand(1), "", I);
+			I->replaceAllUsesWith(N);
+			I->eraseFromParent();
+			return true;
+		}
+		case Mutation::MK_ROR:{
+			ICmpInst *CI = dyn_cast<ICmpInst>(I);
+			if(CI == NULL){
+				return false;
+			}
+			if(rec.op_2 == CmpInst::FCMP_FALSE || rec.op_2 == CmpInst::FCMP_TRUE){
+				CI->replaceAllUsesWith(ConstantInt::get(CI->getType(), rec.op_2 == CmpInst::FCMP_TRUE));
+				CI->eraseFromParent();
+			}else{
+				CI->setPredicate((CmpInst::Predicate) rec.op_2);
+			}
+			return true;
+		}
+		case Mutation::MK_LVR:{
+			if(rec.op_0 >= (int) I->getNumOperands() || !isa<ConstantInt>(I->getOperand(rec.op_0))){
+				return false;
+			}
+			I->setOperand(rec.op_0, ConstantInt::get(I->getOperand(rec.op_0)->getType(), rec.op_2, true));
+			return true;
+		}
+		case Mutation::MK_UOI:{
+			if(rec.op_1 >= I->getNumOperands() || !I->getOperand(rec.op_1)->getType()->isIntegerTy()){
+				return false;
+			}
+			Value *V = I->getOperand(rec.op_1);
+			Instruction *N;
+			if(rec.op_2 == 0){
+				N = BinaryOperator::CreateAdd(V, ConstantInt::get(V->getType(), 1), "", I);
+			}else if(rec.op_2 == 1){
+				N = BinaryOperator::CreateSub(V, ConstantInt::get(V->getType(), 1), "", I);
+			}else{
+				N = BinaryOperator::CreateNeg(V, "", I);
+			}
+			I->setOperand(rec.op_1, N);
+			return true;
+		}
+		case Mutation::MK_ROV:{
+			if(rec.op_1 >= I->getNumOperands() || rec.op_2 >= I->getNumOperands()){
+				return false;
+			}
+			Value *V = I->getOperand(rec.op_1);
+			I->setOperand(rec.op_1, I->getOperand(rec.op_2));
+			I->setOperand(rec.op_2, V);
+			return true;
+		}
+		case Mutation::MK_ABV:{
+			if(rec.op_0 >= (int) I->getNumOperands() || !I->getOperand(rec.op_0)->getType()->isIntegerTy()){
+				return false;
+			}
+			Value *V = I->getOperand(rec.op_0);
+			Instruction *neg = BinaryOperator::CreateNeg(V, "", I);
+			Instruction *isneg = new ICmpInst(I, CmpInst::ICMP_SLT, V, ConstantInt::get(V->getType(), 0));
+			I->setOperand(rec.op_0, SelectInst::Create(isneg, neg, V, "", I));
+			return true;
+		}
+		case Mutation::MK_STD:{
+			//the call returns the retval of the mutant without being called
+			if(isa<CallInst>(I) && !I->getType()->isVoidTy()){
+				if(!I->getType()->isIntegerTy()){
+					return false;
+				}
+				I->replaceAllUsesWith(ConstantInt::get(I->getType(), rec.op_2, true));
+			}else if(!isa<CallInst>(I) && !isa<StoreInst>(I)){
+				return false;
+			}
+			I->eraseFromParent();
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+string MutationTCE::getDigest(Function *copy, legacy::FunctionPassManager &FPM){
+	FPM.run(*copy);
+	return hashFunction(copy);
+}
+
+string MutationTCE::hashFunction(Function *copy){
+	//the values are printed by their positions
+	for(Function::arg_iterator A = copy->arg_begin(); A != copy->arg_end(); ++A){
+		A->setName("");
+	}
+	for(Function::iterator BB = copy->begin(); BB != copy->end(); ++BB){
+		BB->setName("");
+		for(BasicBlock::iterator I = BB->begin(); I != BB->end(); ++I){
+			I->setName("");
+		}
+	}
+
+	string text;
+	raw_string_ostream os(text);
+	copy->print(os);
+	os.flush();
+
+	MD5 hash;
+	hash.update(text);
+	MD5::MD5Result res;
+	hash.final(res);
+	SmallString<32> digest;
+	MD5::stringifyResult(res, digest);
+	return digest.str();
+}
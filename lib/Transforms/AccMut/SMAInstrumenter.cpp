@@ -58,6 +58,15 @@ SMAInstrumenter::SMAInstrumenter(Module *M) : FunctionPass(ID) {
 }
 
 
+bool SMAInstrumenter::doFinalization(Module &M){
+#if ACCMUT_EMBED_MUTATIONS
+	MutUtil::embedMutations(M);
+	return true;
+#else
+	return false;
+#endif
+}
+
 bool SMAInstrumenter::runOnFunction(Function & F){
         if(F.getName().startswith("__accmut__")){
                 return false;
@@ -73,6 +82,9 @@ bool SMAInstrumenter::runOnFunction(Function & F){
 
         llvm::errs()<<"\n######## SMA INSTRUMTNTING MUT  @"<<TheModule->getName()<<"->"<<F.getName()<<"()  ########\n\n";     
 
+        //the indexes of the mutants are the ones of F before instrumenting
+        MutUtil::getInstructions(F, Insts);
+
         instrument(F, v);
 
         return true;
@@ -80,8 +92,6 @@ bool SMAInstrumenter::runOnFunction(Function & F){
 
 
 void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
-
-        int instrumented_insts = 0;
         
         Function::iterator cur_bb;
         BasicBlock::iterator cur_it;
@@ -101,7 +111,7 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
                         }
                 }
                 
-                cur_it =  getLocation(F, instrumented_insts, tmp[0]->index);
+                cur_it =  MutUtil::getLocation(F, Insts, tmp[0]->index);
 
                 cur_bb = cur_it->getParent();
 
@@ -109,13 +119,6 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
                 mut_from = tmp.front()->id;
                 mut_to = tmp.back()->id;
 
-                if(tmp.size() >= MAX_MUT_NUM_PER_LOCATION){
-                        llvm::errs()<<"TOO MANY MUTS@ "<<__FUNCTION__<<"() : "<<__LINE__<<"\n";
-                        llvm::errs()<<"CUR_INST: "<<tmp.front()->index<<"\t(FROM: "
-                                <<mut_from<<"\tTO: "<<mut_to<<")\t"<<*cur_it<<"\n";
-                        exit(0);
-                }
-                
                 llvm::errs()<<"CUR_INST: "<<tmp.front()->index<<"\t(FROM: "
                         <<mut_from<<"\tTO: "<<mut_to<<")\t"<<*cur_it<<"\n";
 
@@ -129,7 +132,6 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
                                         StoreInst *str = new StoreInst(cons, alloca, cur_it);
                                         LoadInst *ld = new LoadInst(alloca, "const_load", cur_it);
                                         *OI = (Value*) ld;
-                                        instrumented_insts += 3;//add 'alloca', 'store' and 'load'
                                 }
                         }
 
@@ -249,14 +251,12 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
                         //label_if_end
                         if(oricall->getType()->isVoidTy()){
                                 cur_it->eraseFromParent();
-                                instrumented_insts += 6;
                         }
                         else{
                                 PHINode* call_res = PHINode::Create(IntegerType::get(TheModule->getContext(), 32), 2, "call.phi");
                                 call_res->addIncoming(oricall, label_if_then);
                                 call_res->addIncoming(stdcall, label_if_else);
                                 ReplaceInstWithInst(cur_it, call_res);
-                                instrumented_insts += 7;
                         }
 
                 }
@@ -268,7 +268,6 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
                                         LoadInst *ld = new LoadInst(alloca, "const_load", st);
                                         User::op_iterator OI = st->op_begin();
                                         *OI = (Value*) ld;
-                                        instrumented_insts += 3;
                         }
 
                         Function* prestfunc;
@@ -343,7 +342,6 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 
                         //label_if_end
                         cur_it->eraseFromParent();      
-                        instrumented_insts += 4;
                 }
                 else{
 #endif
@@ -409,8 +407,6 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
                             int_call_params.push_back(cur_it->getOperand(1));
                             CallInst *call = CallInst::Create(f_process, int_call_params, "", cur_it);
                             CastInst* i32_conv = new TruncInst(call, IntegerType::get(TheModule->getContext(), 1), "");
-
-                            instrumented_insts++;
                             
                             ReplaceInstWithInst(cur_it, i32_conv);
                         }
@@ -424,19 +420,6 @@ void SMAInstrumenter::instrument(Function &F, vector<Mutation*> * v){
 }
 
 
-BasicBlock::iterator SMAInstrumenter::getLocation(Function &F, int instrumented_insts, int index){
-	int cur = 0;
-	for(Function::iterator FI = F.begin(); FI != F.end(); ++FI){
-		BasicBlock *BB = FI;
-		for(BasicBlock::iterator BI = BB->begin(); BI != BB->end(); ++BI, cur++){
-			if(index + instrumented_insts == cur ){
-				return BI;
-			}
-		}
-	}
-	return F.back().end();
-}
-
 
 /*------------------reserved begin-------------------*/
 void SMAInstrumenter::getAnalysisUsage(AnalysisUsage &AU) const {
@@ -2,6 +2,7 @@
 #include "llvm/Transforms/AccMut/StatisticsUtils.h"
 
 #include "llvm/Pass.h"
+#include "llvm/Analysis/CFG.h"
 #include "llvm/ADT/SmallVector.h"
 //#include "llvm/Analysis/Verifier.h"
 #include "llvm/IR/BasicBlock.h"
@@ -18,6 +19,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include <algorithm>
 
 map<StringRef, int> ExecInstNums::funcNameID;
@@ -166,3 +168,67 @@ void ExecInstNums::getAnalysisUsage(AnalysisUsage &AU) const {
 char ExecInstNums::ID = 0;
 /*-----------------reserved end --------------------*/
 
+
+
+/*------------------exec budget-------------------*/
+ExecBudget::ExecBudget(Module *M) : FunctionPass(ID) {
+	this->TheModule = M;
+}
+
+// __accmut__exec_count++; if over __accmut__exec_limit, time out
+void ExecBudget::insertTick(Instruction *before){
+	LLVMContext &C = TheModule->getContext();
+	Type *I64 = Type::getInt64Ty(C);
+
+	Constant *count = TheModule->getOrInsertGlobal("__accmut__exec_count", I64);
+	Constant *limit = TheModule->getOrInsertGlobal("__accmut__exec_limit", I64);
+	Constant *exceeded = TheModule->getOrInsertFunction("__accmut__exec_budget_exceeded",
+		Type::getVoidTy(C), nullptr);
+
+	LoadInst *cur = new LoadInst(count, "budget.cur", before);
+	Instruction *next = BinaryOperator::CreateAdd(cur, ConstantInt::get(I64, 1), "budget.next", before);
+	new StoreInst(next, count, before);
+	LoadInst *lim = new LoadInst(limit, "budget.limit", before);
+	ICmpInst *over = new ICmpInst(before, ICmpInst::ICMP_UGT, next, lim, "budget.over");
+
+	TerminatorInst *then = SplitBlockAndInsertIfThen(over, before, false);
+	CallInst *call = CallInst::Create(exceeded, "", then);
+	call->setCallingConv(CallingConv::C);
+	call->setTailCall(false);
+}
+
+bool ExecBudget::runOnFunction(Function & F){
+	if(F.getName().startswith("__accmut__")){
+		return false;
+	}
+
+	SmallVector<std::pair<const BasicBlock*, const BasicBlock*>, 8> backedges;
+	FindFunctionBackedges(F, backedges);
+
+	//the sources first, the splits below change the blocks
+	std::vector<BasicBlock*> latches;
+	for(unsigned i = 0; i < backedges.size(); i++){
+		BasicBlock *bb = const_cast<BasicBlock*>(backedges[i].first);
+		if(std::find(latches.begin(), latches.end(), bb) == latches.end()){
+			latches.push_back(bb);
+		}
+	}
+
+	for(unsigned i = 0; i < latches.size(); i++){
+		insertTick(latches[i]->getTerminator());
+	}
+
+	//after the allocas, they have to stay in the entry block
+	BasicBlock::iterator it = F.getEntryBlock().getFirstInsertionPt();
+	while(isa<AllocaInst>(&*it)){
+		++it;
+	}
+	insertTick(&*it);
+	return true;
+}
+
+void ExecBudget::getAnalysisUsage(AnalysisUsage &AU) const {
+}
+
+char ExecBudget::ID = 0;
+/*------------------exec budget end---------------*/
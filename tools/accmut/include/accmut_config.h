@@ -31,9 +31,6 @@
 //SWITCH FOR DYNAMIC ANALYSIS
 #define ACCMUT_DYNAMIC_ANALYSIS_FORK 1
 
-//for DMA FORK
-#define MAXMUTNUM 65536
-
 #define PAGESIZE 4096
 
 
@@ -70,7 +67,7 @@ struct rusage usage_cbegin, usage_cend;
 unsigned long long EXEC_INSTS = 0;
 /**********************************************************/
 
-#define MUTFILELINE 128
+#define MUTFILELINE 256
 
 #include "accmut_mut.h"
 
@@ -78,7 +75,7 @@ unsigned long long EXEC_INSTS = 0;
 
 #include "accmut_async_sig_safe_string.h"
 
-Mutation* ALLMUTS[MAXMUTNUM + 1];
+Mutation** ALLMUTS;	//MUT_NUM + 1 entries, grown by __accmut__load_all_muts
 int MUT_NUM;
 int *MUTS_ON;
 
@@ -379,6 +376,7 @@ void __accmut__load_all_muts(){
 		exit(0);
 	}
 	int id = 1;	
+	int cap = 1024;
 	char type[4];
 	char buff[MUTFILELINE];	
 	char tail[40];
@@ -390,8 +388,24 @@ void __accmut__load_all_muts(){
 	char pre_func[64] = {0};
 	#endif
 
+	ALLMUTS = (Mutation **)malloc(sizeof(Mutation *) * (cap + 1));
+	if(ALLMUTS == NULL){
+		fprintf(stderr, "MALLOC ERROR: ALLMUTS\n");
+		exit(0);
+	}
+	ALLMUTS[0] = NULL;
+
 	while(fgets(buff, MUTFILELINE, fp)){
 
+		if(id > cap){
+			cap *= 2;
+			ALLMUTS = (Mutation **)realloc(ALLMUTS, sizeof(Mutation *) * (cap + 1));
+			if(ALLMUTS == NULL){
+				fprintf(stderr, "MALLOC ERROR: ALLMUTS\n");
+				exit(0);
+			}
+		}
+
 		#if ACCMUT_STATIC_ANALYSIS_EVAL
 			char func[64] = {0};
 			sscanf(buff, "%3s:%[^:]:%d:%s", type, func, &idx, tail);
@@ -20,30 +20,66 @@
 
 /** Added By Shiyqw **/
 
-#define MMPL (64) //MAX MUT NUM PER LOCATION 
+#define MMPL (64) //INITIAL MUT NUM PER LOCATION, THE BUFFERS GROW ON DEMAND
 
-int forked_active_set[MMPL];
+int *forked_active_set;
 int forked_active_num;
-int default_active_set[MAXMUTNUM + 1];
-int recent_set[MMPL];
+int *default_active_set;	//MUT_NUM + 1 flags, allocated by __accmut__init
+int *recent_set;
 int recent_num;
 
-long temp_result[MMPL];
+long *temp_result;
 
 typedef struct Eqclass {
     long value;
     int num;
-    int mut_id[MMPL];
+    int cap;
+    int *mut_id;
 } Eqclass;
 
-Eqclass eqclass[MMPL];
+Eqclass *eqclass;
 int eq_num;
 
-//#undef MMPL
+static int loc_cap = 0;
+
+static void *__accmut__loc_realloc(void *p, size_t size){
+    p = realloc(p, size);
+    if(p == NULL){
+        ERRMSG("realloc ERR ");
+        exit(1);
+    }
+    return p;
+}
+
+/* room for n mutants of one location (the original included) */
+static void __accmut__loc_reserve(int n){
+    if(n <= loc_cap){
+        return;
+    }
+    int cap = loc_cap > 0 ? loc_cap : MMPL;
+    while(cap < n){
+        cap *= 2;
+    }
+    forked_active_set = (int *)__accmut__loc_realloc(forked_active_set, sizeof(int) * cap);
+    recent_set = (int *)__accmut__loc_realloc(recent_set, sizeof(int) * cap);
+    temp_result = (long *)__accmut__loc_realloc(temp_result, sizeof(long) * cap);
+    eqclass = (Eqclass *)__accmut__loc_realloc(eqclass, sizeof(Eqclass) * cap);
+    memset(eqclass + loc_cap, 0, sizeof(Eqclass) * (cap - loc_cap));
+    loc_cap = cap;
+}
+
+static void __accmut__eq_push(Eqclass *c, int mut_id){
+    if(c->num == c->cap){
+        c->cap = c->cap > 0 ? c->cap * 2 : 4;
+        c->mut_id = (int *)__accmut__loc_realloc(c->mut_id, sizeof(int) * c->cap);
+    }
+    c->mut_id[c->num++] = mut_id;
+}
 
 // Algorithms for Dynamic mutation anaylsis 
 
 void __accmut__filter__variant(int from, int to) {
+    __accmut__loc_reserve(to - from + 2);
     recent_num = 0;
     int i;
     if (MUTATION_ID == 0) {
@@ -94,7 +130,7 @@ void __accmut__divide__eqclass() {
         #if USING_DIVIDE
         for(j = 0; j < eq_num; ++j) {
             if(eqclass[j].value == result) {
-                eqclass[j].mut_id[eqclass[j].num++] = recent_set[i];
+                __accmut__eq_push(&eqclass[j], recent_set[i]);
                 flag = 1;
                 break;
             }
@@ -103,8 +139,8 @@ void __accmut__divide__eqclass() {
 
         if (flag == 0) {
             eqclass[eq_num].value = result;
-            eqclass[eq_num].num = 1;
-            eqclass[eq_num].mut_id[0] = recent_set[i];
+            eqclass[eq_num].num = 0;
+            __accmut__eq_push(&eqclass[eq_num], recent_set[i]);
             ++eq_num;
         }
     }
@@ -125,7 +161,7 @@ void __accmut__divide__eqclass_cmp(int onlyhas_0, int onlyhas_1) {
         eqclass[0].value = 0;
 
         for(i = 0; i < recent_num; ++i) {
-            eqclass[0].mut_id[eqclass[0].num++] = recent_set[i];
+            __accmut__eq_push(&eqclass[0], recent_set[i]);
         }
         eq_num = 1;
         return;
@@ -135,7 +171,7 @@ void __accmut__divide__eqclass_cmp(int onlyhas_0, int onlyhas_1) {
         eqclass[0].value = 1;
 
         for(i = 0; i < recent_num; ++i) {
-            eqclass[0].mut_id[eqclass[0].num++] = recent_set[i];
+            __accmut__eq_push(&eqclass[0], recent_set[i]);
         }
         eq_num = 1;
         return;
@@ -143,8 +179,9 @@ void __accmut__divide__eqclass_cmp(int onlyhas_0, int onlyhas_1) {
 
     int res_0 = temp_result[0];
 
-    eqclass[0].num = 1;
+    eqclass[0].num = 0;
     eqclass[0].value = res_0;
+    __accmut__eq_push(&eqclass[0], recent_set[0]);
 
     eqclass[1].num = 0;
     eqclass[1].value = 1 - res_0;
@@ -155,9 +192,9 @@ void __accmut__divide__eqclass_cmp(int onlyhas_0, int onlyhas_1) {
         // printf("CPM : MID %d -> TMPRES %d\n", recent_set[i], temp_result[i]);
 
         if(temp_result[i] == res_0){
-            eqclass[0].mut_id[eqclass[0].num++] = recent_set[i];
+            __accmut__eq_push(&eqclass[0], recent_set[i]);
         }else{
-            eqclass[1].mut_id[eqclass[1].num++] = recent_set[i];
+            __accmut__eq_push(&eqclass[1], recent_set[i]);
         }
     }
     eq_num = 2;
@@ -169,8 +206,8 @@ void __accmut__divide__eqclass_cl_st() {
 
     if(recent_num == 1){
         eq_num = 1;
-        eqclass[0].num = 1;
-        eqclass[0].mut_id[0] = recent_set[0];
+        eqclass[0].num = 0;
+        __accmut__eq_push(&eqclass[0], recent_set[0]);
         return;
     }
 
@@ -184,18 +221,14 @@ void __accmut__divide__eqclass_cl_st() {
 
         if(result == 0){
             if(cur_zero_num == 0){
-                eqclass[0].num = 1;
-                eqclass[0].mut_id[0] = recent_set[i];
-                cur_zero_num = 1;
-            }else{
-                eqclass[0].mut_id[cur_zero_num] = recent_set[i];
-                cur_zero_num ++;
-                eqclass[0].num = cur_zero_num;
+                eqclass[0].num = 0;
             }
+            __accmut__eq_push(&eqclass[0], recent_set[i]);
+            cur_zero_num ++;
         }else{
             int idx = i - cur_zero_num  + 1;
-            eqclass[idx].num = 1;
-            eqclass[idx].mut_id[0] = recent_set[i];
+            eqclass[idx].num = 0;
+            __accmut__eq_push(&eqclass[idx], recent_set[i]);
         }
     }
     if(cur_zero_num > 0){
@@ -363,6 +396,12 @@ void __accmut__init(){
 
     __accmut__load_all_muts();
 
+    default_active_set = (int *)malloc(sizeof(int) * (MUT_NUM + 1));
+    if(default_active_set == NULL){
+        ERRMSG("malloc ERR ");
+        exit(1);
+    }
+
     int i;
     for(i = 0; i <= MUT_NUM; ++i){
         default_active_set[i] = 1;
@@ -57,7 +57,7 @@ typedef struct _ACCMUT_FILE{
 #define DEF_STDFILE(NAME, FD, BUF, MAXSIZE, FLAGS) \
 	ACCMUT_FILE NAME = {FLAGS, FD, BUF, (BUF + MAXSIZE), BUF, BUF, 0}
 
-DEF_STDFILE(stdfile_0, 0, NULL, 0, 0);	//unimplemented stdin
+DEF_STDFILE(stdfile_0, 0, NULL, 0, O_RDONLY);	//read in by __accmut__stdin_init
 DEF_STDFILE(stdfile_1, 1, STDOUT_BUFF, MAX_STDOUT_BUF_SIZE, O_WRONLY);
 DEF_STDFILE(stdfile_2, 2, STDERR_BUFF, MAX_STDERR_BUF_SIZE, O_WRONLY);
 
@@ -186,11 +186,69 @@ int __accmut__fclose(ACCMUT_FILE *fp){
 }
 
 
-int __accmut__fseek(ACCMUT_FILE *fp, size_t offset, int loc){
-	//TODO
+/*
+* An input file can be positioned anywhere in its buffer, an output file
+* only grows at its end.
+*/
+int __accmut__fseek(ACCMUT_FILE *fp, long offset, int loc){
+	long cur, end;
+	if(fp->flags & O_WRONLY){
+		cur = end = fp->write_cur - fp->bufbase;
+	}else{
+		cur = fp->read_cur - fp->bufbase;
+		end = fp->fsize;
+	}
+
+	long pos;
+	switch(loc){
+		case SEEK_SET:
+			pos = offset;
+			break;
+		case SEEK_CUR:
+			pos = cur + offset;
+			break;
+		case SEEK_END:
+			pos = end + offset;
+			break;
+		default:
+			return -1;
+	}
+
+	if(pos < 0 || ((fp->flags & O_WRONLY) && pos != end)){
+		return -1;
+	}
+	if((fp->flags & O_WRONLY) == 0){
+		fp->read_cur = fp->bufbase + (pos < end ? pos : end);
+	}
+	fp->flags &= ~_IO_EOF_SEEN;
 	return 0;
 }
 
+long __accmut__ftell(ACCMUT_FILE *fp){
+	if(fp->flags & O_WRONLY){
+		return fp->write_cur - fp->bufbase;
+	}
+	return fp->read_cur - fp->bufbase;
+}
+
+void __accmut__rewind(ACCMUT_FILE *fp){
+	__accmut__fseek(fp, 0, SEEK_SET);
+}
+
+int __accmut__fgetpos(ACCMUT_FILE *fp, fpos_t *pos){
+	memset(pos, 0, sizeof(fpos_t));
+	pos->__pos = __accmut__ftell(fp);
+	return 0;
+}
+
+int __accmut__fsetpos(ACCMUT_FILE *fp, const fpos_t *pos){
+	return __accmut__fseek(fp, pos->__pos, SEEK_SET);
+}
+
+void __accmut__clearerr(ACCMUT_FILE *fp){
+	fp->flags &= ~_IO_EOF_SEEN;
+}
+
 int __accmut__ferror(ACCMUT_FILE *fp){
 	//TODO:
 	return 0;
@@ -205,7 +263,7 @@ int __accmut__feof(ACCMUT_FILE *fp){
 	if(fp == NULL){
 		return EOF;
 	}
-	if((fp->flags & O_RDONLY) == 0){
+	if(fp->flags & O_WRONLY){
 		#if ACCMUT_IO_DEBUG
 		fprintf(stderr, "OPLY SUPPORT O_RDONLY MODE @__accmut__feof\n");
 		#endif
@@ -324,6 +382,14 @@ int __accmut__getc(ACCMUT_FILE *fp){
 	return  *((unsigned char *) fp->read_cur++);
 }
 
+int __accmut__fgetc(ACCMUT_FILE *fp){
+	return __accmut__getc(fp);
+}
+
+int __accmut__getchar(){
+	return __accmut__getc(accmut_stdin);
+}
+
 size_t __accmut__fread(void *buf, size_t size, size_t count, ACCMUT_FILE *fp){
 	if(fp->flags & _IO_EOF_SEEN != 0){
 		return  0;
@@ -813,25 +879,42 @@ static int __accmut___doscan(register ACCMUT_FILE *stream, const char *format, v
 }
 
 
-int __accmut__fscanf(ACCMUT_FILE *fp, const char *format, ...){
+int __accmut__vfscanf(ACCMUT_FILE *fp, const char *format, va_list ap){
 	if(fp->flags & _IO_EOF_SEEN != 0){
 		return  EOF;
 	}
 
 	if(fp->read_cur - fp->bufbase >= fp->fsize){
 		#if ACCMUT_IO_DEBUG
-			fprintf(stderr, "READ OVERFLOW @ __accmut__getc, TID: %d, MUT: %d, fd: %d\n", TEST_ID, MUTATION_ID, fp->fd);
+			fprintf(stderr, "READ OVERFLOW @ __accmut__vfscanf, TID: %d, MUT: %d, fd: %d\n", TEST_ID, MUTATION_ID, fp->fd);
 		#endif
 		fp->flags |= _IO_EOF_SEEN;
 		return EOF;
 	}
 
+	return __accmut___doscan(fp, format, ap);
+}
+
+int __accmut__fscanf(ACCMUT_FILE *fp, const char *format, ...){
 	va_list ap;
     int retval;
 
     va_start(ap, format);
 
-    retval = __accmut___doscan(fp, format, ap);
+    retval = __accmut__vfscanf(fp, format, ap);
+
+    va_end(ap);
+
+    return retval;
+}
+
+int __accmut__scanf(const char *format, ...){
+	va_list ap;
+    int retval;
+
+    va_start(ap, format);
+
+    retval = __accmut__vfscanf(accmut_stdin, format, ap);
 
     va_end(ap);
 
@@ -857,6 +940,10 @@ int __accmut__fputc(int c, ACCMUT_FILE *fp){
 //putc implemented as a macro 
 #define __accmut__putc(c, f) ( __accmut__fputc(c, f) )
 
+int __accmut__putchar(int c){
+	return __accmut__fputc(c, accmut_stdout);
+}
+
 
 int __accmut__fputs(const char* s, ACCMUT_FILE *fp){
 	int result = EOF;
@@ -905,20 +992,16 @@ int __accmut__puts(const char* s){
 // 	return 0;
 // }
 
-int __accmut__fprintf(ACCMUT_FILE *fp, const char *format, ...){
+int __accmut__vfprintf(ACCMUT_FILE *fp, const char *format, va_list ap){
 
 	if(fp == NULL){
 		#if ACCMUT_IO_DEBUG
-			fprintf(stderr, "NULL ACCMUT FILE  !!! @__accmut__fprintf, TID: %d, MUT: %d\n", TEST_ID, MUTATION_ID);
+			fprintf(stderr, "NULL ACCMUT FILE  !!! @__accmut__vfprintf, TID: %d, MUT: %d\n", TEST_ID, MUTATION_ID);
 		#endif
 		return 0;
 	}
 
-	int ret;
-	va_list ap;
-	va_start(ap, format);
-	ret = vsprintf(fp->write_cur, format, ap);	//TODO:: use (STDOUT_BUFF + CUR_STDOUT) instead of tmp
-	va_end(ap);
+	int ret = vsprintf(fp->write_cur, format, ap);	//TODO:: use (STDOUT_BUFF + CUR_STDOUT) instead of tmp
 
 	int max;
 	switch(fp->fd){
@@ -938,7 +1021,7 @@ int __accmut__fprintf(ACCMUT_FILE *fp, const char *format, ...){
 
 	if((fp->write_cur - fp->bufbase) + ret  > max){
 		#if ACCMUT_IO_DEBUG
-			fprintf(stderr, "ACCMUT BUFFER OVERFLOW !  @__accmut__fprintf. TID:%d, MUT: %d, fd: %d\n", TEST_ID, MUTATION_ID, fp->fd);
+			fprintf(stderr, "ACCMUT BUFFER OVERFLOW !  @__accmut__vfprintf. TID:%d, MUT: %d, fd: %d\n", TEST_ID, MUTATION_ID, fp->fd);
 		#endif
 		return 0;
 	}
@@ -947,16 +1030,21 @@ int __accmut__fprintf(ACCMUT_FILE *fp, const char *format, ...){
 	return ret;
 }
 
-int __accmut__printf(const char *format, ...){
+int __accmut__fprintf(ACCMUT_FILE *fp, const char *format, ...){
 	int ret;
 	va_list ap;
 	va_start(ap, format);
-	ret = vsprintf(accmut_stdout->write_cur, format, ap);	//TODO:: use (STDOUT_BUFF + CUR_STDOUT) instead of tmp
+	ret = __accmut__vfprintf(fp, format, ap);
 	va_end(ap);
+	return ret;
+}
+
+int __accmut__vprintf(const char *format, va_list ap){
+	int ret = vsprintf(accmut_stdout->write_cur, format, ap);	//TODO:: use (STDOUT_BUFF + CUR_STDOUT) instead of tmp
 
 	if((accmut_stdout->write_cur - accmut_stdout->bufbase) + ret  > MAX_STDOUT_BUF_SIZE){
 		#if ACCMUT_IO_DEBUG
-			fprintf(stderr, "ACCMUT STDOUT BUF OVERFLOW !  @__accmut__printf, TID: %d, MUT: %d\n", TEST_ID, MUTATION_ID);
+			fprintf(stderr, "ACCMUT STDOUT BUF OVERFLOW !  @__accmut__vprintf, TID: %d, MUT: %d\n", TEST_ID, MUTATION_ID);
 		#endif
 		return 0;
 	}
@@ -965,6 +1053,15 @@ int __accmut__printf(const char *format, ...){
 	return ret;
 }
 
+int __accmut__printf(const char *format, ...){
+	int ret;
+	va_list ap;
+	va_start(ap, format);
+	ret = __accmut__vprintf(format, ap);
+	va_end(ap);
+	return ret;
+}
+
 size_t __accmut__fwrite(const void *buf, size_t size, size_t count, ACCMUT_FILE *fp){
 	int request = size*count;
 	if(fp->write_cur + request > fp->bufend){
@@ -1004,7 +1101,31 @@ void __accmut__exit_check_output(){
 	// }
 }
 
+//the whole stdin into memory before the first fork, the mutants read their own copy
+void __accmut__stdin_init(){
+	size_t cap = LINE_BUF_SIZE, len = 0;
+	char *buf = (char *)malloc(cap);
+	ssize_t n;
+	while(buf != NULL && (n = read(STDIN_FILENO, buf + len, cap - len)) > 0){
+		len += n;
+		if(len == cap){
+			cap *= 2;
+			buf = (char *)realloc(buf, cap);
+		}
+	}
+	if(buf == NULL){
+		fprintf(stderr, "STDIN MALLOC ERROR !!!!!!\n");
+		exit(0);
+	}
+	stdfile_0.bufbase = stdfile_0.read_cur = buf;
+	stdfile_0.fsize = len;
+	stdfile_0.bufend = buf + len;
+}
+
 void __accmut__oracal_bufinit(){
+	__accmut__stdin_init();
+
+
 	char path[120];
 	sprintf(path, "%st%d", ORACLEDIR, TEST_ID);
 	int fd = open(path, O_RDONLY);
@@ -10,12 +10,12 @@
 //#define fprintf UNIMPL
 //#define fscanf UNIMPL
 //#define printf UNIMPL
-#define scanf UNIMPL
+//#define scanf UNIMPL
 //#define sprintf UNIMPL
 //#define sscanf UNIMPL
-#define vfprintf UNIMPL
-#define vprintf UNIMPL
-#define vsprintf UNIMPL
+//#define vfprintf UNIMPL
+//#define vprintf UNIMPL
+//#define vsprintf UNIMPL
 
 //File Operation functions
 //#define fclose UNIMPL
@@ -30,33 +30,33 @@
 #define tmpnam UNIMPL
 
 //Character Input/Output functions
-#define fgetc UNIMPL
+//#define fgetc UNIMPL
 //#define fgets UNIMPL
 //#define fputc UNIMPL
 //#define fputs UNIMPL
 //#define getc UNIMPL
-#define getchar UNIMPL
+//#define getchar UNIMPL
 #define gets UNIMPL
 //#define putc UNIMPL
-#define putchar UNIMPL
+//#define putchar UNIMPL
 //#define puts UNIMPL
 //#define ungetc UNIMPL
 
 
 //Block Input/Output functions
-#define fread UNIMPL
+//#define fread UNIMPL
 //#define fwrite UNIMPL
 
 //File Positioning functions
-#define fgetpos UNIMPL
-#define fseek UNIMPL
-#define fsetpos UNIMPL
-#define ftell UNIMPL
-#define rewind UNIMPL
+//#define fgetpos UNIMPL
+//#define fseek UNIMPL
+//#define fsetpos UNIMPL
+//#define ftell UNIMPL
+//#define rewind UNIMPL
 
 //Error Handling functions
-#define clearerr UNIMPL
-#define feof UNIMPL
+//#define clearerr UNIMPL
+//#define feof UNIMPL
 //#define ferror UNIMPL
 //#define perror UNIMPL
 
@@ -84,11 +84,16 @@
 /****** FILE OPTIONS ******/
 #define fopen(a,b) __accmut__fopen(a,b)
 #define fclose(a) __accmut__fclose(a)
-//#define fseek(a,b,c) __accmut__fseek(a,b,c)
 #define ferror(a) __accmut__ferror(a)
 #define fileno(a) __accmut__fileno(a)
 #define freopen(a,b,c) __accmut__freopen(a,b,c)
 #define feof(a) __accmut__feof(a)
+#define fseek(a,b,c) __accmut__fseek(a,b,c)
+#define ftell(a) __accmut__ftell(a)
+#define rewind(a) __accmut__rewind(a)
+#define fgetpos(a,b) __accmut__fgetpos(a,b)
+#define fsetpos(a,b) __accmut__fsetpos(a,b)
+#define clearerr(a) __accmut__clearerr(a)
 
 
 /****** POSIX FILE ******/
@@ -99,17 +104,23 @@
 #define getc(a) __accmut__getc(a)
 #define fread(a,b,c,d) __accmut__fread(a,b,c,d)
 #define ungetc(a,b) __accmut__ungetc(a,b)
+#define fgetc(a) __accmut__fgetc(a)
+#define getchar() __accmut__getchar()
 #define fscanf(...) __accmut__fscanf(__VA_ARGS__)
+#define scanf(...) __accmut__scanf(__VA_ARGS__)
 
 
 /****** OUTPUT ******/
 #define fputc(a,b) __accmut__fputc(a,b)
 #define putc(a,b) __accmut__putc(a,b)
+#define putchar(a) __accmut__putchar(a)
 #define puts(a) __accmut__puts(a)
 #define fputs(a,b) __accmut__fputs(a,b)
 #define fwrite(a,b,c,d) __accmut__fwrite(a,b,c,d)
 #define fprintf(...) __accmut__fprintf(__VA_ARGS__)
 #define printf(...) __accmut__printf(__VA_ARGS__)
+#define vfprintf(a,b,c) __accmut__vfprintf(a,b,c)
+#define vprintf(a,b) __accmut__vprintf(a,b)
 
 #define perror(a) __accmut__perror(a)
 #define fflush(a) __accmut__fflush(a)
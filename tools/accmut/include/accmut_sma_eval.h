@@ -8,19 +8,19 @@
 
 #include <accmut/accmut_arith_common.h>
 
-#define MAXINDEXNUM MAXMUTNUM
-
 #define MAX_COV_TIME 1
 
-int COVERED_LOCATIONS[MAXINDEXNUM];
+/* sized from MUT_NUM in __accmut__init(), a location is at most MUT_NUM + 1 */
+
+int *COVERED_LOCATIONS;
 
-long ORIRES[MAXINDEXNUM];
+long *ORIRES;
 
-long MUTRES[MAXMUTNUM];
+long *MUTRES;
 
-int UNSUPORTED[MAXMUTNUM];
+int *UNSUPORTED;
 
-int PARENT[MAXMUTNUM];
+int *PARENT;
 
 #define MUT_TP_ERR (2)
 
@@ -1039,6 +1039,16 @@ void __accmut__init(){
 
     __accmut__load_all_muts();
 
+    COVERED_LOCATIONS = (int *)calloc(MUT_NUM + 2, sizeof(int));
+    ORIRES = (long *)calloc(MUT_NUM + 2, sizeof(long));
+    MUTRES = (long *)calloc(MUT_NUM + 1, sizeof(long));
+    UNSUPORTED = (int *)calloc(MUT_NUM + 1, sizeof(int));
+    PARENT = (int *)calloc(MUT_NUM + 1, sizeof(int));
+    if(COVERED_LOCATIONS == NULL || ORIRES == NULL || MUTRES == NULL || UNSUPORTED == NULL || PARENT == NULL){
+        ERRMSG("calloc ERR ");
+        exit(0);
+    }
+
     int i;
 
     for(i = 1; i <= MUT_NUM; i++){// removing muts within a loop
@@ -83,6 +83,8 @@ long __accmut__cal_i64_arith(int op, long a, long b){// TODO:: add float point
 
 int __accmut__cal_i32_bool(int pre, int a, int b){
 	switch(pre){
+		case 0: return 0;	//FCMP_FALSE, the constant ROR mutants of ACCMUT_GEN_MUT_PRUNE
+		case 15: return 1;	//FCMP_TRUE
 		case 32: return a == b;
 		case 33: return a != b;
 		case 34: return ((unsigned) a) > ((unsigned) b);
@@ -102,6 +104,8 @@ int __accmut__cal_i32_bool(int pre, int a, int b){
 
 int __accmut__cal_i64_bool(int pre, long a, long b){
 	switch(pre){
+		case 0: return 0;	//FCMP_FALSE, the constant ROR mutants of ACCMUT_GEN_MUT_PRUNE
+		case 15: return 1;	//FCMP_TRUE
 		case 32: return a == b;
 		case 33: return a != b;
 		case 34: return ((unsigned long) a) > ((unsigned long) b);
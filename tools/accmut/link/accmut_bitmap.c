@@ -0,0 +1,32 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "accmut_bitmap.h"
+
+unsigned long *__accmut__bitmap_map(const char *path, long bits, int create){
+
+	int fd = open(path, O_RDWR | (create ? O_CREAT : 0), 0644);
+	if(fd < 0){
+		return NULL;
+	}
+
+	size_t sz = ACCMUT_BITMAP_WORDS(bits) * sizeof(unsigned long);
+	if(sz == 0){
+		sz = sizeof(unsigned long);
+	}
+
+	struct stat sb;
+	if(fstat(fd, &sb) < 0 || ((size_t)sb.st_size < sz && ftruncate(fd, sz) < 0)){
+		close(fd);
+		return NULL;
+	}
+
+	void *map = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED){
+		return NULL;
+	}
+	return (unsigned long *)map;
+}
@@ -0,0 +1,30 @@
+#ifndef ACCMUT_BITMAP_H
+#define ACCMUT_BITMAP_H
+
+/* bitsets indexed by mutant id */
+
+#define ACCMUT_WORD_BITS (8 * sizeof(unsigned long))
+
+#define ACCMUT_BITMAP_WORDS(bits) (((bits) + ACCMUT_WORD_BITS - 1) / ACCMUT_WORD_BITS)
+
+#define ACCMUT_BIT_TEST(map, i) \
+	(((map)[(i) / ACCMUT_WORD_BITS] >> ((i) % ACCMUT_WORD_BITS)) & 1UL)
+
+#define ACCMUT_BIT_SET(map, i) \
+	((map)[(i) / ACCMUT_WORD_BITS] |= 1UL << ((i) % ACCMUT_WORD_BITS))
+
+#define ACCMUT_BIT_CLEAR(map, i) \
+	((map)[(i) / ACCMUT_WORD_BITS] &= ~(1UL << ((i) % ACCMUT_WORD_BITS)))
+
+/* for the bitmaps shared between processes */
+#define ACCMUT_BIT_SET_ATOMIC(map, i) \
+	__sync_fetch_and_or(&(map)[(i) / ACCMUT_WORD_BITS], 1UL << ((i) % ACCMUT_WORD_BITS))
+
+/*
+* Map a bitmap file of at least `bits` bits shared and writable.
+* A short file is extended with zero bits. Returns NULL if the file
+* does not exist (and create is 0) or can not be mapped.
+*/
+unsigned long *__accmut__bitmap_map(const char *path, long bits, int create);
+
+#endif
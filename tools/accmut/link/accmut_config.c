@@ -1,5 +1,10 @@
 #include "accmut_config.h"
 #include "accmut_exitcode.h"
+#include "accmut_sched.h"
+#include "accmut_result.h"
+#include "accmut_mutdb.h"
+#include "accmut_forksrv.h"
+#include "accmut_timing.h"
 
 #if ACCMUT_STATIC_ANALYSIS_EVAL
 #include <math.h>
@@ -34,15 +39,54 @@ struct timeval tv_begin, tv_end;
 //FOR STATISTICS
 unsigned long long EXEC_INSTS = 0;
 /**********************************************************/
+//FOR THE EXEC BUDGET, NEVER REACHED BUT IN A FORKED MUTANT
+unsigned long __accmut__exec_count = 0;
+unsigned long __accmut__exec_limit = ~0UL;
+static unsigned long EXEC_BUDGET = 0;
+/**********************************************************/
 
-#define MUTFILELINE 128
+#define MUTFILELINE 256
 
-Mutation* ALLMUTS[MAXMUTNUM + 1];
+Mutation** ALLMUTS = NULL;
 int MUT_NUM;
-int *MUTS_ON;
+unsigned long *MUTS_ON;
+
+/* the stable keys of the mutants 1..MUT_NUM, see accmut_mutdb.h */
+static unsigned long *MUT_KEYS = NULL;
+
+/* room for the mutants 0..num, ALLMUTS is sized by the mutants loaded */
+static void __accmut__alloc_all_muts(int num){
+	ALLMUTS = (Mutation **)realloc(ALLMUTS, sizeof(Mutation *) * (num + 1));
+	MUT_KEYS = (unsigned long *)realloc(MUT_KEYS, sizeof(unsigned long) * (num + 1));
+	if(ALLMUTS == NULL || MUT_KEYS == NULL){
+		ERRMSG("realloc ERR ");
+		exit(MELLOC_ERR);
+	}
+}
 
 
 
+/* before main, see accmut_forksrv.h */
+__attribute__((constructor)) static void __accmut__config_ctor(int argc, char **argv){
+	__accmut__forksrv(argc, argv);
+}
+
+
+void __accmut__test_id_init(){
+	char *env = getenv(ACCMUT_TEST_ID_ENV);
+	if(env == NULL || *env == '\0'){
+		return;
+	}
+	char *end;
+	long id = strtol(env, &end, 10);
+	if(*end != '\0' || id < 0){
+		ERRMSG("ACCMUT_TEST_ID IS NOT A TEST ID ");
+		exit(ENV_ERR);
+	}
+	TEST_ID = (int)id;
+}
+
+
 /************* ALL EXIT HANDLER ***************************/
 void __accmut__exit_check_output();
 
@@ -153,6 +197,8 @@ static void __accmut__omitdump__handler(int sig){
 #endif
 
 #if 1
+	__accmut__result_abort(OUT_CRASH, exitcd);
+	__accmut__sched_release();
 	_exit(exitcd);
 	kill(getpid(), SIGKILL);
 #else
@@ -183,6 +229,8 @@ static void __accmut__timeout_handler(int sig){
 #endif
 
 #if 1
+    __accmut__result_abort(OUT_TIMEOUT, TIMEOUT_ERR);
+    __accmut__sched_release();
     _exit(TIMEOUT_ERR);
     kill(getpid(), SIGKILL);
 #else
@@ -191,6 +239,11 @@ static void __accmut__timeout_handler(int sig){
 
 }
 
+/* the ExecBudget pass calls it when a mutant is over its count */
+void __accmut__exec_budget_exceeded(){
+	__accmut__timeout_handler(SIGPROF);
+}
+
 void __accmut__set_sig_handlers(){
 
 	signal(SIGPROF, __accmut__timeout_handler);
@@ -213,47 +266,121 @@ void __accmut__set_sig_handlers(){
 #define DEFAULT_USEC (5000)
 #define REAL_TIMES (1.5)
 
-void __accmut__sepcific_timer(){
-	long v_sec = 0;
-	long v_usec = 0;
+#define DEFAULT_TIMEOUT_MULT (3.0)
+#define DEFAULT_TIMEOUT_FLOOR (5000)
 
-	char path[128] = {0};
-	sprintf(path, "%s%s%s/%d", getenv("HOME"), "/tmp/accmut/oritime/", PROJECT, TEST_ID);
-	FILE * fp = fopen(path, "r");
-	if(fp == NULL){
-		#if 0
-		__real_fprintf(stderr, "WARNING : ORI TIME FILE DOSE NOT EXISIT : %s\n", path);
-		#endif
-		//if the ori time file does not exisit, use the default timer value.
-		v_sec = DEFAULT_SEC;
-		v_usec = DEFAULT_USEC;
-	}else{
-		fscanf(fp, "%ld", &v_sec);
-		fscanf(fp, "%ld", &v_usec);
-		fclose(fp);
+#define DEFAULT_EXEC_BUDGET_MULT (10)
+#define EXEC_BACKSTOP_TIMES (10)
+
+static void __accmut__set_tick(struct itimerval *tick, long usec, long interval_usec){
+	tick->it_value.tv_sec = usec / 1000000;
+	tick->it_value.tv_usec = usec % 1000000;
+	tick->it_interval.tv_sec = interval_usec / 1000000;
+	tick->it_interval.tv_usec = interval_usec % 1000000;
+}
+
+/* the budget of the mutants from the timing index, 0 on success */
+static int __accmut__calibrated_timer(long *prof_usec, long *real_usec){
+
+	char path[256];
+	sprintf(path, "%s%s%s.idx", getenv("HOME"), "/tmp/accmut/oritime/", PROJECT);
+
+	AccmutTiming t;
+	if(__accmut__timing_lookup(path, TEST_ID, &t) != 0){
+		return -1;
 	}
-	
-    ACCMUT_PROF_TICK.it_value.tv_sec = v_sec;  // sec
-    ACCMUT_PROF_TICK.it_value.tv_usec = v_usec; // u sec.
-    ACCMUT_PROF_TICK.it_interval.tv_sec = INTTERVAL_SEC;
-    ACCMUT_PROF_TICK.it_interval.tv_usec =  INTTERVAL_USEC;
 
-    
-	ACCMUT_REAL_TICK.it_value.tv_sec = v_sec * REAL_TIMES;  // sec
-    ACCMUT_REAL_TICK.it_value.tv_usec = v_usec * REAL_TIMES; // u sec.
-    ACCMUT_REAL_TICK.it_interval.tv_sec = INTTERVAL_SEC * REAL_TIMES;
-    ACCMUT_REAL_TICK.it_interval.tv_usec =  INTTERVAL_USEC * REAL_TIMES;
+	double mult = DEFAULT_TIMEOUT_MULT;
+	long floor = DEFAULT_TIMEOUT_FLOOR;
+	char *env = getenv(ACCMUT_TIMEOUT_MULT_ENV);
+	if(env != NULL && atof(env) > 0){
+		mult = atof(env);
+	}
+	env = getenv(ACCMUT_TIMEOUT_FLOOR_ENV);
+	if(env != NULL && atol(env) > 0){
+		floor = atol(env);
+	}
+
+	//the program counts, the main process has come through main already
+	if(t.exec_count > 0 && __accmut__exec_count > 0){
+		long budget_mult = DEFAULT_EXEC_BUDGET_MULT;
+		env = getenv(ACCMUT_EXEC_BUDGET_MULT_ENV);
+		if(env != NULL && atol(env) > 0){
+			budget_mult = atol(env);
+		}
+		EXEC_BUDGET = t.exec_count * budget_mult;
+	}
+
+	*prof_usec = t.cpu_p95 * mult;
+	*real_usec = t.real_p95 * mult;
+	if(*prof_usec < floor){
+		*prof_usec = floor;
+	}
+	if(*real_usec < floor){
+		*real_usec = floor;
+	}
+	return 0;
+}
+
+void __accmut__sepcific_timer(){
+	long prof_usec = 0;
+	long real_usec = 0;
+
+	if(__accmut__calibrated_timer(&prof_usec, &real_usec) != 0){
+		long v_sec = 0;
+		long v_usec = 0;
+
+		char path[128] = {0};
+		sprintf(path, "%s%s%s/%d", getenv("HOME"), "/tmp/accmut/oritime/", PROJECT, TEST_ID);
+		FILE * fp = fopen(path, "r");
+		if(fp == NULL){
+			#if 0
+			__real_fprintf(stderr, "WARNING : ORI TIME FILE DOSE NOT EXISIT : %s\n", path);
+			#endif
+			//neither the index nor the ori time file, use the default timer value.
+			v_sec = DEFAULT_SEC;
+			v_usec = DEFAULT_USEC;
+		}else{
+			fscanf(fp, "%ld", &v_sec);
+			fscanf(fp, "%ld", &v_usec);
+			fclose(fp);
+		}
+		prof_usec = v_sec * 1000000 + v_usec;
+		real_usec = prof_usec * REAL_TIMES;
+	}
+
+	__accmut__set_tick(&ACCMUT_PROF_TICK, prof_usec, INTTERVAL_SEC * 1000000 + INTTERVAL_USEC);
+	__accmut__set_tick(&ACCMUT_REAL_TICK, real_usec, (INTTERVAL_SEC * 1000000 + INTTERVAL_USEC) * REAL_TIMES);
 
     #if 0
     __real_fprintf(stderr, "PROFTIMER: %ld %ld ; REALTIMER: %ld %ld\n", 
     				ACCMUT_PROF_TICK.it_value.tv_sec ,
-    				ACCMUT_PROF_TICK.it_value.tv_usec = v_usec , 
+    				ACCMUT_PROF_TICK.it_value.tv_usec , 
     				ACCMUT_REAL_TICK.it_value.tv_sec , 
     				ACCMUT_REAL_TICK.it_value.tv_usec);
     #endif
 }
 
 
+int __accmut__arm_timeout(){
+	if(EXEC_BUDGET > 0){
+		__accmut__exec_limit = EXEC_BUDGET;
+
+		//only for the blocking calls, the count decides
+		struct itimerval backstop = ACCMUT_REAL_TICK;
+		long usec = (ACCMUT_REAL_TICK.it_value.tv_sec * 1000000 + ACCMUT_REAL_TICK.it_value.tv_usec)
+					* EXEC_BACKSTOP_TIMES;
+		backstop.it_value.tv_sec = usec / 1000000;
+		backstop.it_value.tv_usec = usec % 1000000;
+		return setitimer(ITIMER_REAL, &backstop, NULL);
+	}
+
+	int r1 = setitimer(ITIMER_REAL, &ACCMUT_REAL_TICK, NULL); 
+	int r2 = setitimer(ITIMER_PROF, &ACCMUT_PROF_TICK, NULL); 
+	return (r1 < 0 || r2 < 0) ? -1 : 0;
+}
+
+
 void __accmut__exec_inst_nums(){
 	// fprintf(stderr, "0");
 	EXEC_INSTS++;
@@ -264,124 +391,164 @@ void __accmut__debug(int index){
 	
 }
 
+__attribute__((weak)) int __accmut__checkoutput(){
+	return 0;
+}
+
+__attribute__((weak)) unsigned long __accmut__files_digest(){
+	return 0;
+}
+
+__attribute__((weak)) int __accmut__represented_muts(const int **muts){
+	*muts = &MUTATION_ID;
+	return 1;
+}
+
+
+extern const AccmutEmbeddedMut __start_accmut_muts[] __attribute__((weak));
+extern const AccmutEmbeddedMut __stop_accmut_muts[] __attribute__((weak));
+
+/* the mutants of the modules which are not linked in, never reached */
+static Mutation NOT_LINKED_MUT;
+
+static int __accmut__load_embedded_muts(){
+	const AccmutEmbeddedMut *e;
+
+	const AccmutEmbeddedMut *start = &__start_accmut_muts[0];
+	const AccmutEmbeddedMut *stop = &__stop_accmut_muts[0];
+
+	//the weak symbols are null without the section
+	if(start == NULL || start == stop){
+		return 0;
+	}
+
+	MUT_NUM = 0;
+	for(e = start; e < stop; e++){
+		if(e->mut_num > MUT_NUM){
+			MUT_NUM = e->mut_num;
+		}
+	}
+	__accmut__alloc_all_muts(MUT_NUM);
+
+	int i;
+	for(i = 0; i <= MUT_NUM; i++){
+		ALLMUTS[i] = &NOT_LINKED_MUT;
+		MUT_KEYS[i] = 0;
+	}
+	for(e = start; e < stop; e++){
+		ALLMUTS[e->id] = (Mutation *)&e->mut;
+		MUT_KEYS[e->id] = e->key;
+	}
+	return 1;
+}
+
+static AccmutMutDB MUTDB;
+
+static int __accmut__load_mutdb(const char *txt_path){
+	char path[256];
+	sprintf(path, "%s%s", getenv("HOME"), "/tmp/accmut/mutations.db");
+
+	if(__accmut__mutdb_map(path, &MUTDB) != 0){
+		return 0;
+	}
+	//mutations.txt has been sampled by hand since, trust the text
+	if(__accmut__mutdb_stale(&MUTDB, txt_path)){
+		__accmut__mutdb_unmap(&MUTDB);
+		return 0;
+	}
+	__accmut__alloc_all_muts(MUTDB.header->mut_num);
+	ALLMUTS[0] = NULL;
+	MUT_KEYS[0] = 0;
+
+	int i;
+	for(i = 1; i <= MUTDB.header->mut_num; i++){
+		ALLMUTS[i] = &MUTDB.muts[i - 1];
+		MUT_KEYS[i] = MUTDB.locs[i - 1].key;
+	}
+	MUT_NUM = MUTDB.header->mut_num;
+	return 1;
+}
+
+unsigned long __accmut__mut_key(int id){
+	if(MUT_KEYS == NULL || id < 1 || id > MUT_NUM){
+		return 0;
+	}
+	return MUT_KEYS[id];
+}
 
 void __accmut__load_all_muts(){
+
+	//loaded by the fork server already
+	if(ALLMUTS != NULL){
+		return;
+	}
+
+	if(__accmut__load_embedded_muts()){
+		return;
+	}
+
     char path[256];
     strcpy(path, getenv("HOME"));
     strcat(path, "/tmp/accmut/mutations.txt");
+
+	if(__accmut__load_mutdb(path)){
+		return;
+	}
+
 	FILE *fp = fopen(path, "r");
 	if(fp == NULL){
 		ERRMSG("mutation.txt OPEN ERR");
 		exit(FOPEN_ERR);
 	}
 	int id = 1;	
-	char type[4];
+	int cap = 1024;
 	char buff[MUTFILELINE];	
-	char tail[40];
+
+	__accmut__alloc_all_muts(cap);
+	ALLMUTS[0] = NULL;
+	MUT_KEYS[0] = 0;
 	
-	#if ACCMUT_STATIC_ANALYSIS_EVAL
 	int idx;
 	int cur_loc = 1;	//begin from 1, not 0
 	int pre_idx = -1;
-	char pre_func[64] = {0};
-	#endif
+	char pre_func[MUTFILELINE] = {0};
 
 	while(fgets(buff, MUTFILELINE, fp)){
 
-		#if ACCMUT_STATIC_ANALYSIS_EVAL
-			char func[64] = {0};
-			sscanf(buff, "%3s:%[^:]:%d:%s", type, func, &idx, tail);
-
-			int is_in_loop = 0;
-			if(idx < 0){
-				idx = 0 - idx;
-				is_in_loop = 1;
-			}
-
-			Mutation* m = (Mutation *)malloc(sizeof(Mutation));
-
-			if((strcmp(pre_func, func)) != 0 || idx != pre_idx){
-				cur_loc++;
-			}
-			pre_idx = idx;
-			strcpy(pre_func, func);
-			if(is_in_loop)
-				m->location = 0 - cur_loc;
-			else
-				m->location = cur_loc;
-		#else
-			sscanf(buff, "%3s:%*[^:]:%*[^:]:%s", type, tail);
-			Mutation* m = (Mutation *)malloc(sizeof(Mutation));	
-		#endif
-
-		if(!strcmp(type, "AOR")){
-			m->type = AOR;
-			int s_op, t_op;
-			sscanf(tail, "%d:%d", &s_op, &t_op);
-			m->sop = s_op;
-			m->op_0 = t_op;
-		}else if(!strcmp(type, "LOR")){
-			m->type = LOR;
-			int s_op, t_op;
-			sscanf(tail, "%d:%d", &s_op, &t_op);
-			m->sop = s_op;
-			m->op_0 = t_op;
-		}else if(!strcmp(type, "ROR")){
-			m->type = ROR;
-			int op, s_pre, t_pre;
-			sscanf(tail, "%d:%d:%d", &op, &s_pre, &t_pre);
-			m->sop = op;
-			m->op_1 = s_pre;
-			m->op_2 = t_pre;
-		}else if(!strcmp(type, "STD")){
-			m->type = STD;
-			int op, f_tp, retval;
-			if(strlen(tail) == 4){//return void 
-				sscanf(tail, "%d:%d", &op, &f_tp);
-				m->sop = op;	//must be 0
-				m->op_1 = f_tp;
-			}else{//return i32 or i64
-				sscanf(tail, "%d:%d:%d", &op, &f_tp, &retval);
-				m->sop = op;
-				m->op_1 = f_tp;	//32, or 64
-				m->op_2 = retval;
-			}
-		}else if(!strcmp(type, "LVR")){
-			m->type = LVR;
-			int op, op_i;
-			long s_c, t_c;
-			sscanf(tail, "%d:%d:%ld:%ld", &op, &op_i, &s_c, &t_c);
-			m->sop = op;
-			m->op_0 = op_i;
-			m->op_1 = s_c;
-			m->op_2 = t_c;
-		}else if(!strcmp(type, "UOI")){
-			m->type = UOI;
-			int op, op_i, tp;
-			sscanf(tail, "%d:%d:%d", &op, &op_i, &tp);
-			m->sop = op;
-			m->op_1 = op_i;
-			m->op_2 = tp;
-		}else if(!strcmp(type, "ROV")){
-			m->type = ROV;
-			int op, op1, op2;
-			sscanf(tail, "%d:%d:%d", &op, &op1, &op2);
-			m->sop = op;
-			m->op_1 = op1;
-			m->op_2 = op2;
-		}else if(!strcmp(type, "ABV")){
-			m->type = ABV;
-			int op, op_i;
-			sscanf(tail, "%d:%d", &op, &op_i);
-			m->sop = op;
-			m->op_0 = op_i;
-		}else{
+		if(id > cap){
+			cap *= 2;
+			__accmut__alloc_all_muts(cap);
+		}
+
+		char func[MUTFILELINE] = {0};
+		Mutation* m = (Mutation *)malloc(sizeof(Mutation));
+
+		if(__accmut__mutdb_parse_line(buff, m, func, &idx) != 0){
 			__real_fprintf(stderr, "ERROR MUT TYPE: %d:%s\n", id, buff);
 			exit(MUT_TP_ERR);
 		}
+
+		int is_in_loop = 0;
+		if(idx < 0){
+			idx = 0 - idx;
+			is_in_loop = 1;
+		}
+
+		if((strcmp(pre_func, func)) != 0 || idx != pre_idx){
+			cur_loc++;
+		}
+		pre_idx = idx;
+		strcpy(pre_func, func);
+		if(is_in_loop)
+			m->location = 0 - cur_loc;
+		else
+			m->location = cur_loc;
+
 		ALLMUTS[id] = m;
+		MUT_KEYS[id] = __accmut__mutdb_parse_key(buff);
 		id++;
 	}
+	fclose(fp);
 	MUT_NUM = id - 1;
 
 	#if 0
@@ -391,13 +558,8 @@ void __accmut__load_all_muts(){
 	for(i = 1; i <= MUT_NUM; i++){
 		Mutation *m = ALLMUTS[i];
 	
-		#if ACCMUT_STATIC_ANALYSIS_EVAL
-			__real_fprintf(stderr, "MUT %d => LOC: %d , TP: %d , SOP: %d , OP0 : %d , OP1 : %d , OP2 : %d\n",
-				i, m->location, m->type, m->sop, m->op_0, m->op_1, m->op_2);
-		#else
-			__real_fprintf(stderr, "MUT %d => TP: %d , SOP: %d , OP0 : %d , OP1 : %d , OP2 : %d\n",
-				i, m->type, m->sop, m->op_0, m->op_1, m->op_2);
-		#endif
+		__real_fprintf(stderr, "MUT %d => LOC: %d , TP: %d , SOP: %d , OP0 : %d , OP1 : %ld , OP2 : %ld\n",
+			i, m->location, m->type, m->sop, m->op_0, m->op_1, m->op_2);
 	}
 	__real_fprintf(stderr, "----------------- END DUMP ALL MUTS ---------------\n\n");
 
@@ -31,8 +31,6 @@
 //SWITCH FOR DYNAMIC ANALYSIS
 #define ACCMUT_DYNAMIC_ANALYSIS_FORK 0
 
-#define MAXMUTNUM 0x17000
-
 
 extern const char PROJECT[];
 
@@ -48,6 +46,9 @@ extern int HOLDER[1024];
 
 extern int TEST_ID;
 
+/* TEST_ID from ACCMUT_TEST_ID (see accmut_result.h), first thing in __accmut__init() */
+void __accmut__test_id_init();
+
 typedef enum MTYPE{
 	AOR, /* 0 */
 	LOR, /* 1 */
@@ -64,9 +65,9 @@ typedef enum MTYPE{
 typedef struct Mutation{
 	MType type;
 
-	#if ACCMUT_STATIC_ANALYSIS_EVAL	
+	//the IR location, for the static analysis eval.
+	//Always there, the records of mutations.db have this layout
 	int location;
-	#endif
 
 	//src operand, for all muts
 	int sop;
@@ -85,9 +86,10 @@ typedef struct Mutation{
 }Mutation;
 
 
-#define MUTFILELINE 128
+#define MUTFILELINE 256
 
-extern Mutation* ALLMUTS[MAXMUTNUM + 1];
+/* ALLMUTS[1..MUT_NUM], allocated by __accmut__load_all_muts() */
+extern Mutation** ALLMUTS;
 extern int MUT_NUM;
 
 extern struct timeval tv_begin, tv_end;
@@ -125,12 +127,33 @@ void __accmut__set_sig_handlers();
 
 void __accmut__sepcific_timer();
 
+/* counted by the ExecBudget pass, see accmut_timing.h */
+extern unsigned long __accmut__exec_count;
+extern unsigned long __accmut__exec_limit;
+
+void __accmut__exec_budget_exceeded();
+
+/* start the timeout of a forked mutant, -1 on error */
+int __accmut__arm_timeout();
+
 void __accmut__exec_inst_nums();
 
 void __accmut__debug(int index);
 
 void __accmut__load_all_muts();
 
+/* the stable key of a mutant (see accmut_mutdb.h), 0 if it has none */
+unsigned long __accmut__mut_key(int id);
+
+/* whether stdout differs from the oracle, accmut_io.c overrides it */
+int __accmut__checkoutput();
+
+/* the digest of the files the process has written, accmut_io.c overrides it */
+unsigned long __accmut__files_digest();
+
+/* the mutants the current process stands for, the DMA runtime overrides it */
+int __accmut__represented_muts(const int **muts);
+
 
 
 #endif
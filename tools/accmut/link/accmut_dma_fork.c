@@ -18,6 +18,10 @@
 #include "accmut_config.h"
 #include "accmut_io.h"
 #include "accmut_exitcode.h"
+#include "accmut_sched.h"
+#include "accmut_eqclass.h"
+#include "accmut_result.h"
+#include "accmut_bitmap.h"
 
 
 extern struct itimerval ACCMUT_PROF_TICK;
@@ -28,49 +32,108 @@ extern struct timeval tv_begin, tv_end;
 //extern int MUTATION_ID;
 extern int TEST_ID;
 
-extern Mutation* ALLMUTS[MAXMUTNUM + 1];
 
 
 //#define fprintf __real_fprintf
 #define __real_fprintf fprintf
 
 
-#define MMPL 64 //MAX MUT NUM PER LOCATION 
+/*
+* The buffers of one location hold the original and all the mutants of it.
+* MMPL of them are static, when a location has more mutants (a call with
+* many integer arguments) __accmut__init() mallocs them big enough.
+*/
+#define MMPL 64 //MUT NUM PER LOCATION OF THE STATIC BUFFERS
+
+static int forked_active_buf[MMPL];
+static int recent_buf[MMPL];
+static long temp_result_buf[MMPL];
+static Eqclass eqclass_buf[MMPL];
+static int eq_members_buf[MMPL];
+static int eq_cls_of_buf[MMPL];
+static unsigned eq_stamp_buf[2 * MMPL];
+static int eq_slot_buf[2 * MMPL];
+
+static int *forked_active_set = forked_active_buf; 
+static int forked_active_num;
+static unsigned long *default_active_set;	/* bitmap of MUT_NUM + 1 bits */
+static int *recent_set = recent_buf;
+static int recent_num;
+static long *temp_result = temp_result_buf;
 
-/****** switch on for divide eq cls *******/
-#define USING_DIVIDE 0
+static Eqclass *eqclass = eqclass_buf;
+static int eq_num;
 
-#define DIV_EQ_CMP USING_DIVIDE
-#define DIV_EQ_CL_ST USING_DIVIDE
+static int *eq_members = eq_members_buf;
+static int *eq_cls_of = eq_cls_of_buf;
+static EqclassHash eq_hash = {0, 2 * MMPL - 1, eq_stamp_buf, eq_slot_buf};
 
+static void* __accmut__loc_alloc(size_t size){
+    void *p = malloc(size);
+    if(p == NULL){
+        ERRMSG("malloc ERR ");
+        exit(MELLOC_ERR);
+    }
+    return p;
+}
 
-static int forked_active_set[MMPL]; 
-static int forked_active_num;
-static int default_active_set[MAXMUTNUM + 1];
-static int recent_set[MMPL];
-static int recent_num;
-static long temp_result[MMPL];
+/* make room for the location with the most mutants */
+static void __accmut__init_loc_buffers(){
+    int max = 0, cur = 0, pre_loc = 0;
+    int i;
+    for(i = 1; i <= MUT_NUM; ++i){
+        int loc = abs(ALLMUTS[i]->location);
+        if(loc == 0){	// not linked in
+            cur = 0;
+        }else if(loc == pre_loc){
+            cur++;
+        }else{
+            cur = 1;
+        }
+        pre_loc = loc;
+        if(cur > max){
+            max = cur;
+        }
+    }
 
-typedef struct Eqclass {
-    long value;
-    int num;
-    int mut_id[MMPL];
-} Eqclass;
+    int n = max + 1;	// and the original
+    if(n <= MMPL){
+        return;
+    }
 
-static Eqclass eqclass[MMPL];
-static int eq_num;
+    unsigned size = 2 * MMPL;
+    while(size < 2 * (unsigned)n){
+        size <<= 1;
+    }
+
+    forked_active_set = (int *)__accmut__loc_alloc(sizeof(int) * n);
+    recent_set = (int *)__accmut__loc_alloc(sizeof(int) * n);
+    temp_result = (long *)__accmut__loc_alloc(sizeof(long) * n);
+    eqclass = (Eqclass *)__accmut__loc_alloc(sizeof(Eqclass) * n);
+    eq_members = (int *)__accmut__loc_alloc(sizeof(int) * n);
+    eq_cls_of = (int *)__accmut__loc_alloc(sizeof(int) * n);
+    eq_hash.gen = 0;
+    eq_hash.mask = size - 1;
+    eq_hash.stamp = (unsigned *)calloc(size, sizeof(unsigned));
+    eq_hash.cls = (int *)__accmut__loc_alloc(sizeof(int) * size);
+    if(eq_hash.stamp == NULL){
+        ERRMSG("calloc ERR ");
+        exit(MELLOC_ERR);
+    }
+}
 
 #undef MMPL
 
 // Algorithms for Dynamic mutation anaylsis 
 
 void __accmut__filter__variant(int from, int to) {
+    __accmut__cover(from, to);
     recent_num = 0;
     int i;
     if (MUTATION_ID == 0) {
         recent_set[recent_num++] = 0;
         for(i = from; i <= to; ++i) {
-            if (default_active_set[i] == 1) {
+            if (ACCMUT_BIT_TEST(default_active_set, i)) {
                 recent_set[recent_num++] = i;
             }
         }
@@ -100,127 +163,13 @@ void __accmut__dump_eqclass(){
     }
 }
 
-#if DIV_EQ_CMP
-void __accmut__divide__eqclass_cmp(int onlyhas_0, int onlyhas_1) {
-
-    int i;
-    if(onlyhas_0 == 0){
-
-        eqclass[0].num = 0;
-        eqclass[0].value = 0;
-
-        for(i = 0; i < recent_num; ++i) {
-            eqclass[0].mut_id[eqclass[0].num++] = recent_set[i];
-        }
-        eq_num = 1;
-        return;
-    }else if(onlyhas_1 == 1){
-        
-        eqclass[0].num = 0;
-        eqclass[0].value = 1;
-
-        for(i = 0; i < recent_num; ++i) {
-            eqclass[0].mut_id[eqclass[0].num++] = recent_set[i];
-        }
-        eq_num = 1;
-        return;
-    }
-
-    int res_0 = temp_result[0];
-
-    eqclass[0].num = 1;
-    eqclass[0].value = res_0;
-
-    eqclass[1].num = 0;
-    eqclass[1].value = 1 - res_0;
-
-
-    for(i = 1; i < recent_num; ++i) {
-
-        // printf("CPM : MID %d -> TMPRES %d\n", recent_set[i], temp_result[i]);
-
-        if(temp_result[i] == res_0){
-            eqclass[0].mut_id[eqclass[0].num++] = recent_set[i];
-        }else{
-            eqclass[1].mut_id[eqclass[1].num++] = recent_set[i];
-        }
-    }
-    eq_num = 2;
-    // __accmut__dump_eqclass();
-}
-#endif
-
-
-#if DIV_EQ_CL_ST
-void __accmut__divide__eqclass_cl_st() {
-
-    if(recent_num == 1){
-        eq_num = 1;
-        eqclass[0].num = 1;
-        eqclass[0].mut_id[0] = recent_set[0];
-        return;
-    }
-
-    int cur_zero_num = 0;
-    int i;
-    for(i = 0; i < recent_num; ++i) {
-
-        long result = temp_result[i];
-
-        // printf("CLST : MID %d -> TMPRES %d\n", recent_set[i], temp_result[i]);
-
-        if(result == 0){
-            if(cur_zero_num == 0){
-                eqclass[0].num = 1;
-                eqclass[0].mut_id[0] = recent_set[i];
-                cur_zero_num = 1;
-            }else{
-                eqclass[0].mut_id[cur_zero_num] = recent_set[i];
-                cur_zero_num ++;
-                eqclass[0].num = cur_zero_num;
-            }
-        }else{
-            int idx = i - cur_zero_num  + 1;
-            eqclass[idx].num = 1;
-            eqclass[idx].mut_id[0] = recent_set[i];
-        }
-    }
-    if(cur_zero_num > 0){
-        eq_num = recent_num - cur_zero_num + 1;
-    }else{
-        eq_num = 1;
-    }
-
-    //__accmut__dump_eqclass();
-}
-#endif
-
-
+/*
+* Mutants computing the same value share one class and one process,
+* the classes are found by hashing the values (see accmut_eqclass.c).
+*/
 void __accmut__divide__eqclass() {
-    eq_num = 0;
-    int i;
-    for(i = 0; i < recent_num; ++i) {
-        long result = temp_result[i];
-        int j;
-        int flag = 0;
-        
-        #if USING_DIVIDE
-        for(j = 0; j < eq_num; ++j) {
-            if(eqclass[j].value == result) {
-                eqclass[j].mut_id[eqclass[j].num++] = recent_set[i];
-                flag = 1;
-                break;
-            }
-        }
-        #endif
-        
-        if (flag == 0) {
-            eqclass[eq_num].value = result;
-            eqclass[eq_num].num = 1;
-            eqclass[eq_num].mut_id[0] = recent_set[i];
-            ++eq_num;
-        }
-    }
+    eq_num = __accmut__partition_eqclass(temp_result, recent_set, recent_num,
+                                         eqclass, eq_members, eq_cls_of, &eq_hash);
 }
 /*-------------------------EQ CLS------------------------------------*/
 
@@ -229,10 +178,10 @@ void __accmut__filter__mutants(int from, int to, int classid) {
     int j;
     if(eqclass[classid].mut_id[0] == 0) {
         for(j = from; j <= to; ++j) {
-            default_active_set[j] = 0;
+            ACCMUT_BIT_CLEAR(default_active_set, j);
         }
         for(j = 0; j < eqclass[classid].num; ++j) {
-           default_active_set[eqclass[classid].mut_id[j]] = 1;
+           ACCMUT_BIT_SET(default_active_set, eqclass[classid].mut_id[j]);
         }
     } else {
         forked_active_num = 0;
@@ -248,8 +197,7 @@ long __accmut__fork__eqclass(int from, int to) {
         return eqclass[0].value;
     }
 
-    int result = eqclass[0].value;
-    int id = eqclass[0].mut_id[0];
+    long result = eqclass[0].value;
     int i;
     
     /** fork **/
@@ -261,7 +209,7 @@ long __accmut__fork__eqclass(int from, int to) {
          fprintf(stderr, "#\n");
     #endif
 
-         pid = fork();
+         pid = __accmut__sched_fork();
 
          if(pid < 0){
             ERRMSG("fork FAILED ");
@@ -270,12 +218,9 @@ long __accmut__fork__eqclass(int from, int to) {
 
          if(pid == 0) {
 
-            int r1 = setitimer(ITIMER_REAL, &ACCMUT_REAL_TICK, NULL); 
-            int r2 = setitimer(ITIMER_PROF, &ACCMUT_PROF_TICK, NULL); 
-
             // printf("REAL: %ld, PROF: %ld\n", ACCMUT_REAL_TICK.it_value.tv_usec,  ACCMUT_REAL_TICK.it_interval.tv_usec);
 
-            if(r1 < 0 || r2 < 0){
+            if(__accmut__arm_timeout() < 0){
                 ERRMSG("setitimer ERR ");
                 exit(ENV_ERR);
             }
@@ -294,6 +239,8 @@ long __accmut__fork__eqclass(int from, int to) {
                 exit(ENV_ERR);
             }
 
+            __accmut__result_start();
+
             #if 0
             fprintf(stderr, "%d %d\n", TEST_ID, MUTATION_ID);
             #endif
@@ -301,8 +248,6 @@ long __accmut__fork__eqclass(int from, int to) {
             return eqclass[i].value;
          } else {
 
-            int pr = waitpid(pid, NULL, 0);
-
             struct itimerval MAIN_REAL_TICK, MAIN_PROF_TICK;
             MAIN_REAL_TICK.it_value.tv_sec = 0;  // sec
             MAIN_REAL_TICK.it_value.tv_usec = 100000; // u sec.
@@ -311,10 +256,6 @@ long __accmut__fork__eqclass(int from, int to) {
             int r1 = setitimer(ITIMER_REAL, &MAIN_REAL_TICK, NULL); 
             int r2 = setitimer(ITIMER_PROF, &MAIN_PROF_TICK, NULL); 
 
-            if(pr < 0){
-                ERRMSG("waitpid ERR ");
-                exit(ENV_ERR);
-            }
             // fprintf(stderr, "FATHER-> MUT: %d , PID: %d\n", MUTATION_ID, getpid());
 
             #if 0
@@ -345,6 +286,16 @@ long __accmut__fork__eqclass(int from, int to) {
 }// end __accmut__fork__eqclass
 
 
+/* all the mutants a forked process stands for, reported at exit */
+int __accmut__represented_muts(const int **muts){
+    if(MUTATION_ID == 0){
+        *muts = &MUTATION_ID;
+        return 1;
+    }
+    *muts = forked_active_set;
+    return forked_active_num;
+}
+
 /** End Added **/
 
 
@@ -352,6 +303,8 @@ extern int MUT_NUM;
 
 void __accmut__init(){
 
+    __accmut__test_id_init();
+
     gettimeofday(&tv_begin, NULL);
     
     atexit(__accmut__exit_time);
@@ -360,9 +313,7 @@ void __accmut__init(){
     
     __accmut__set_sig_handlers();
 
-    #if 0
-    __accmut__init_stdstream();
-    #endif
+    __accmut__sched_init();
 
     if(TEST_ID < 0){
         ERRMSG("TEST_ID NOT INIT");
@@ -371,9 +322,24 @@ void __accmut__init(){
 
     __accmut__load_all_muts();
 
+    __accmut__result_init();
+
+    //stdin and the oracle of the test, before the first fork
+    __accmut__init_stdstream();
+
+    __accmut__init_loc_buffers();
+
+    default_active_set = (unsigned long *)calloc(ACCMUT_BITMAP_WORDS(MUT_NUM + 1), sizeof(unsigned long));
+    if(default_active_set == NULL){
+        ERRMSG("calloc ERR ");
+        exit(MELLOC_ERR);
+    }
+
     int i;
     for(i = 0; i <= MUT_NUM; ++i){
-        default_active_set[i] = 1;
+        if(__accmut__in_group(i) && !__accmut__is_killed(i) && __accmut__is_covered(i)){
+            ACCMUT_BIT_SET(default_active_set, i);
+        }
     }
 }
 
@@ -613,17 +579,10 @@ int __accmut__process_i32_cmp(int from, int to, int left, int right){
 // }
 
     // generate recent_set
-    int onlyhas_1 = 1;
-    int onlyhas_0 = 0;
-    
     int i;
     for(i = 0; i < recent_num; ++i){
         if(recent_set[i] == 0) {
             temp_result[i] = ori;
-            
-            onlyhas_1 &= ori;
-            onlyhas_0 |= ori;
-            
             continue;
         }
 
@@ -696,9 +655,6 @@ int __accmut__process_i32_cmp(int from, int to, int left, int right){
         }//end switch
         
         temp_result[i] = mut_res;
-        
-        onlyhas_1 &= mut_res;
-        onlyhas_0 |= mut_res;
     }//end for i
 
     if(recent_num == 1) {
@@ -709,11 +665,7 @@ int __accmut__process_i32_cmp(int from, int to, int left, int right){
     }
 
     /* divide */
-    #if DIV_EQ_CMP
-        __accmut__divide__eqclass_cmp(onlyhas_0, onlyhas_1);
-    #else
-        __accmut__divide__eqclass();
-    #endif
+    __accmut__divide__eqclass();
 
     /* fork */
     int result = __accmut__fork__eqclass(from, to);
@@ -730,18 +682,10 @@ int __accmut__process_i64_cmp(int from, int to, long left, long right){
     __accmut__filter__variant(from, to);
 
     // generate recent_set
-    
-    int onlyhas_1 = 1;
-    int onlyhas_0 = 0;
-    
     int i;
     for(i = 0; i < recent_num; ++i){
         if(recent_set[i] == 0) {
             temp_result[i] = ori;
-            
-            onlyhas_1 &= ori;
-            onlyhas_0 |= ori;
-            
             continue;
         }
 
@@ -814,9 +758,6 @@ int __accmut__process_i64_cmp(int from, int to, long left, long right){
         }//end switch
         
         temp_result[i] = mut_res;
-        
-		onlyhas_1 &= mut_res;
-        onlyhas_0 |= mut_res;
 
     }//end for i
 
@@ -828,11 +769,7 @@ int __accmut__process_i64_cmp(int from, int to, long left, long right){
     }
 
     /* divide */
-    #if DIV_EQ_CMP
-        __accmut__divide__eqclass_cmp(onlyhas_0, onlyhas_1);
-    #else
-        __accmut__divide__eqclass();
-    #endif
+    __accmut__divide__eqclass();
     
     /* fork */
     int result = __accmut__fork__eqclass(from, to);
@@ -1561,11 +1498,7 @@ int __accmut__prepare_call(int from, int to, int opnum, ...){
     }
 
    /* divide */
-    #if DIV_EQ_CL_ST
-    __accmut__divide__eqclass_cl_st();
-    #else
     __accmut__divide__eqclass();
-    #endif
 
     // printf("eq_num : %d\n", eq_num);
     // for (int i = 0; i < eq_num; ++i)
@@ -1714,11 +1647,7 @@ int __accmut__prepare_st_i32(int from, int to, int tobestore, int *addr){
 
 
    /* divide */
-    #if DIV_EQ_CL_ST
-    __accmut__divide__eqclass_cl_st();
-    #else
     __accmut__divide__eqclass();
-    #endif
 
     // for (int i = 0; i < eq_num; ++i)
     // {
@@ -1819,11 +1748,7 @@ int __accmut__prepare_st_i64(int from, int to, long tobestore, long *addr){
 
 
    /* divide */
-    #if DIV_EQ_CL_ST
-    __accmut__divide__eqclass_cl_st();
-    #else
     __accmut__divide__eqclass();
-    #endif
 
     // for (int i = 0; i < eq_num; ++i)
     // {
@@ -0,0 +1,97 @@
+#include <string.h>
+
+#include "accmut_eqclass.h"
+
+static inline unsigned __accmut__hash_value(long value, unsigned mask){
+    unsigned long h = (unsigned long)value * 0x9E3779B97F4A7C15UL;
+    return (unsigned)(h >> 32) & mask;
+}
+
+/* up to this many classes a linear scan beats hashing */
+#define LINEAR_CLASSES 4
+
+static inline int __accmut__hash_insert(EqclassHash *hash, Eqclass *classes, long value, int c){
+    unsigned h = __accmut__hash_value(value, hash->mask);
+    while(hash->stamp[h] == hash->gen){
+        int old = hash->cls[h];
+        if(classes[old].value == value){
+            return old;
+        }
+        h = (h + 1) & hash->mask;
+    }
+    hash->stamp[h] = hash->gen;
+    hash->cls[h] = c;
+    return c;
+}
+
+static void __accmut__hash_reset(EqclassHash *hash){
+    hash->gen++;
+    if(hash->gen == 0){
+        memset(hash->stamp, 0, sizeof(unsigned) * (hash->mask + 1));
+        hash->gen = 1;
+    }
+}
+
+int __accmut__partition_eqclass(const long *values, const int *ids, int n,
+                                Eqclass *classes, int *members, int *cls_of,
+                                EqclassHash *hash){
+    int eq_num = 0;
+    int i, j;
+
+    /* assign every value a class */
+    for(i = 0; i < n; ++i){
+        long value = values[i];
+        int c;
+        if(eq_num <= LINEAR_CLASSES){
+            for(c = 0; c < eq_num; ++c){
+                if(classes[c].value == value){
+                    break;
+                }
+            }
+            if(c == eq_num){
+                eq_num++;
+                classes[c].value = value;
+                classes[c].num = 0;
+                if(eq_num > LINEAR_CLASSES){
+                    __accmut__hash_reset(hash);
+                    for(j = 0; j < eq_num; ++j){
+                        __accmut__hash_insert(hash, classes, classes[j].value, j);
+                    }
+                }
+            }
+        }else{
+            c = __accmut__hash_insert(hash, classes, value, eq_num);
+            if(c == eq_num){
+                eq_num++;
+                classes[c].value = value;
+                classes[c].num = 0;
+            }
+        }
+        cls_of[i] = c;
+        classes[c].num++;
+    }
+
+    /* the common case, nothing to split */
+    if(eq_num == 1){
+        classes[0].num = n;
+        classes[0].mut_id = members;
+        memcpy(members, ids, sizeof(int) * n);
+        return 1;
+    }
+
+    /* lay the classes out in the members buffer,
+       the hash slots are free now and hold the fill positions */
+    int *pos = hash->cls;
+    int offset = 0;
+    for(i = 0; i < eq_num; ++i){
+        classes[i].mut_id = members + offset;
+        pos[i] = offset;
+        offset += classes[i].num;
+    }
+
+    for(i = 0; i < n; ++i){
+        members[pos[cls_of[i]]++] = ids[i];
+    }
+
+    return eq_num;
+}
@@ -0,0 +1,39 @@
+#ifndef ACCMUT_EQCLASS_H
+#define ACCMUT_EQCLASS_H
+
+/*
+* An equivalence class of the mutants at one location:
+* all of them compute the same value in the current state.
+* mut_id points into the members buffer given to the partitioner.
+*/
+typedef struct Eqclass {
+    long value;
+    int num;
+    int *mut_id;
+} Eqclass;
+
+/*
+* Open addressing table keyed by the computed value, used once a location
+* splits into more than a handful of classes. The slots are stamped with a generation number, so a new partition
+* does not need to clear the table. mask + 1 must be a power of two
+* and at least twice the number of values partitioned.
+*/
+typedef struct EqclassHash {
+    unsigned gen;
+    unsigned mask;
+    unsigned *stamp;
+    int *cls;
+} EqclassHash;
+
+/*
+* Partition ids[0..n) by values[0..n).
+* The classes keep the order of their first member, and the members keep
+* their order in ids, so classes[0] always holds ids[0].
+* cls_of is a scratch buffer of n ints, members holds n ids.
+* Returns the number of classes.
+*/
+int __accmut__partition_eqclass(const long *values, const int *ids, int n,
+                                Eqclass *classes, int *members, int *cls_of,
+                                EqclassHash *hash);
+
+#endif
@@ -14,7 +14,8 @@ enum ACCMUT_EXIT_CODE{
 	TIMEOUT_ERR,
 	SIGSEGV_ERR,
 	SIGABRT_ERR,
-	SIGFPE_ERR
+	SIGFPE_ERR,
+	OUTPUT_ERR		/* stdout diverged from the oracle */
 	
 };
 
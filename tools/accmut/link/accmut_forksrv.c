@@ -0,0 +1,160 @@
+#include <errno.h>
+#include <sys/wait.h>
+
+#include "accmut_config.h"
+#include "accmut_exitcode.h"
+#include "accmut_forksrv.h"
+#include "accmut_result.h"
+
+#define __real_fprintf fprintf
+
+extern int TEST_ID;
+
+extern int main(int argc, char **argv);
+
+static int __accmut__forksrv_read(int fd, void *buf, size_t len){
+	size_t done = 0;
+	while(done < len){
+		ssize_t r = read(fd, (char *)buf + done, len - done);
+		if(r < 0 && errno == EINTR){
+			continue;
+		}
+		if(r <= 0){
+			return -1;
+		}
+		done += r;
+	}
+	return 0;
+}
+
+static int __accmut__forksrv_write(int fd, const void *buf, size_t len){
+	size_t done = 0;
+	while(done < len){
+		ssize_t r = write(fd, (const char *)buf + done, len - done);
+		if(r < 0 && errno == EINTR){
+			continue;
+		}
+		if(r <= 0){
+			return -1;
+		}
+		done += r;
+	}
+	return 0;
+}
+
+static void __accmut__forksrv_redirect(const char *path, int fd, int flags){
+	if(path[0] == '\0'){
+		return;
+	}
+	int nfd = open(path, flags, 0644);
+	if(nfd < 0){
+		ERRMSG("FORKSRV OPEN ERR ");
+		exit(FOPEN_ERR);
+	}
+	dup2(nfd, fd);
+	close(nfd);
+}
+
+/* in the forked process of one test */
+static void __accmut__forksrv_run(char *argv0, const AccmutForkReq *req, char *strs){
+	close(ACCMUT_FORKSRV_FD);
+	close(ACCMUT_FORKSRV_FD + 1);
+
+	char **argv = (char **)malloc(sizeof(char *) * (req->argc + 2));
+	if(argv == NULL){
+		ERRMSG("malloc ERR ");
+		exit(MELLOC_ERR);
+	}
+	argv[0] = argv0;
+	int i;
+	char *p = strs;
+	for(i = 1; i <= req->argc; i++){
+		argv[i] = p;
+		p += strlen(p) + 1;
+	}
+	argv[req->argc + 1] = NULL;
+
+	__accmut__forksrv_redirect(p, STDIN_FILENO, O_RDONLY);
+	p += strlen(p) + 1;
+	__accmut__forksrv_redirect(p, STDOUT_FILENO, O_WRONLY | O_CREAT | O_TRUNC);
+
+	char id[16];
+	sprintf(id, "%d", req->test_id);
+	setenv(ACCMUT_TEST_ID_ENV, id, 1);
+	TEST_ID = req->test_id;
+
+	exit(main(req->argc + 1, argv));
+}
+
+void __accmut__forksrv(int argc, char **argv){
+
+	if(getenv(ACCMUT_FORKSRV_ENV) == NULL){
+		return;
+	}
+	//the programs the tests exec are not servers
+	unsetenv(ACCMUT_FORKSRV_ENV);
+
+	int req_fd = ACCMUT_FORKSRV_FD;
+	int rep_fd = ACCMUT_FORKSRV_FD + 1;
+
+	//the work every test would repeat, __accmut__init() finds it done
+	__accmut__load_all_muts();
+
+	int hello = 0;
+	if(__accmut__forksrv_write(rep_fd, &hello, sizeof(hello)) < 0){
+		ERRMSG("FORKSRV HELLO ERR ");
+		exit(ENV_ERR);
+	}
+
+	char *strs = NULL;
+	int cap = 0;
+	AccmutForkReq req;
+
+	while(__accmut__forksrv_read(req_fd, &req, sizeof(req)) == 0){
+
+		if(req.argc < 0 || req.size < 2){
+			ERRMSG("FORKSRV BAD REQUEST ");
+			exit(ENV_ERR);
+		}
+		if(req.size > cap){
+			cap = req.size;
+			strs = (char *)realloc(strs, cap);
+			if(strs == NULL){
+				ERRMSG("realloc ERR ");
+				exit(MELLOC_ERR);
+			}
+		}
+		if(__accmut__forksrv_read(req_fd, strs, req.size) < 0){
+			break;
+		}
+		strs[req.size - 1] = '\0';
+
+		int i, n = 0;
+		for(i = 0; i < req.size; i++){
+			n += strs[i] == '\0';
+		}
+		if(n < req.argc + 2){
+			ERRMSG("FORKSRV BAD REQUEST ");
+			exit(ENV_ERR);
+		}
+
+		pid_t pid = fork();
+		if(pid < 0){
+			ERRMSG("fork FAILED ");
+			exit(ENV_ERR);
+		}
+		if(pid == 0){
+			__accmut__forksrv_run(argv[0], &req, strs);
+		}
+
+		int status = 0;
+		while(waitpid(pid, &status, 0) < 0 && errno == EINTR);
+
+		AccmutForkRep rep = {req.test_id, pid, status, 0};
+		if(__accmut__forksrv_write(rep_fd, &rep, sizeof(rep)) < 0){
+			break;
+		}
+	}
+
+	exit(SUCC);
+}
@@ -0,0 +1,39 @@
+#ifndef ACCMUT_FORKSRV_H
+#define ACCMUT_FORKSRV_H
+
+/*
+* Fork server mode, like the fork server of AFL.
+* With ACCMUT_FORKSRV set the instrumented program loads the mutants once
+* before main, then reads the tests from ACCMUT_FORKSRV_FD and forks a fresh
+* process per test, which runs main with the argv of the test. The wait
+* status of every test goes back on ACCMUT_FORKSRV_FD + 1.
+*
+* The server first writes a 4 bytes hello on the status fd. A test is an
+* AccmutForkReq followed by size bytes: argc arguments, the stdin path and
+* the stdout path, all '\0' terminated. An empty path inherits the fd of
+* the server. EOF on the request fd stops the server.
+*/
+#define ACCMUT_FORKSRV_ENV "ACCMUT_FORKSRV"
+#define ACCMUT_FORKSRV_FD 198
+
+typedef struct AccmutForkReq{
+	int test_id;
+	int argc;		/* the arguments after argv[0] */
+	int size;
+	int reserved;
+}AccmutForkReq;
+
+typedef struct AccmutForkRep{
+	int test_id;
+	int pid;
+	int status;		/* of waitpid() */
+	int reserved;
+}AccmutForkRep;
+
+/*
+* Called before main. Returns at once without ACCMUT_FORKSRV, never returns
+* in the server.
+*/
+void __accmut__forksrv(int argc, char **argv);
+
+#endif
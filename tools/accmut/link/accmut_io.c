@@ -1,3 +1,4 @@
+#define _GNU_SOURCE	/* mremap */
 #include <sys/mman.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,11 +7,14 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdarg.h>
+#include <errno.h>
 
 #include <unistd.h>
 
 #include "accmut_io.h"
 #include "accmut_exitcode.h"
+#include "accmut_result.h"
+#include "accmut_sched.h"
 
 /*************************************************/
 
@@ -20,11 +24,21 @@
 #define ACCMUT_MAX_FILENO (32)
 #define MAX_IN_BUF_SIZE (1<<22)
 
-//4M OUTPUT BUF 
-#define MAX_STDOUT_BUF_SIZE (1<<22)
-#define MAX_STDERR_BUF_SIZE (1<<22)
-#define MAX_FILE_BUF_SIZE (1<<22)
 #define LINE_BUF_SIZE (4096)
+
+//the FILE flags of glibc, no longer in stdio.h since glibc 2.28
+#ifndef _IO_NO_READS
+#define _IO_NO_READS 0x4
+#endif
+#ifndef _IO_NO_WRITES
+#define _IO_NO_WRITES 0x8
+#endif
+#ifndef _IO_EOF_SEEN
+#define _IO_EOF_SEEN 0x10
+#endif
+#ifndef _IO_ERR_SEEN
+#define _IO_ERR_SEEN 0x20
+#endif
 /*************************************************/
 
 # define EOF (-1)
@@ -34,28 +48,49 @@
 extern int TEST_ID;
 extern const char PROJECT[];
 
+//the libc functions behind the wrapped ones, see WRAP_FLAGS in the Makefile
+FILE* __real_fopen(const char *path, const char *mode);
+int __real_fclose(FILE *fp);
+int __real_feof(FILE *fp);
+int __real_ferror(FILE *fp);
+void __real_clearerr(FILE *fp);
+int __real_fseek(FILE *fp, long offset, int loc);
+long __real_ftell(FILE *fp);
+void __real_rewind(FILE *fp);
+int __real_fgetpos(FILE *fp, fpos_t *pos);
+int __real_fsetpos(FILE *fp, const fpos_t *pos);
+int __real_fflush(FILE *fp);
+int __real_unlink(const char *pathname);
+char* __real_fgets(char *buf, int size, FILE *fp);
+int __real_fgetc(FILE *fp);
+int __real_ungetc(int c, FILE *fp);
+size_t __real_fread(void *buf, size_t size, size_t count, FILE *fp);
+int __real_fputc(int c, FILE *fp);
+int __real_fputs(const char *s, FILE *fp);
+int __real_vfprintf(FILE *fp, const char *format, va_list ap);
+size_t __real_fwrite(const void *buf, size_t size, size_t count, FILE *fp);
+
 /***********************************************************/
 //FOR OUTPUT BUFFER
-static const char ORACLEDIR[] = "";
-
-static char STDIN_BUFF[LINE_BUF_SIZE];
-static char STDOUT_BUFF[MAX_STDOUT_BUF_SIZE];
-static char STDERR_BUFF[MAX_STDERR_BUF_SIZE];
-static size_t CUR_STDOUT = 0;
-static size_t CUR_STDERR = 0;
 
 static char *ORACLEBUFF;
 static size_t ORACLESIZE = 0;
+static char EMPTY_ORACLE[1];
+
+//the bytes of stdout already compared with the oracle
+static size_t ORACLE_CHECKED = 0;
 
 /***********************************************************/
 
 
-#define DEF_STDFILE(NAME, FD, BUF, MAXSIZE, FLAGS) \
-	ACCMUT_FILE NAME = {FLAGS, FD, BUF, (BUF + MAXSIZE), BUF, BUF, 0}
+//the output buffers are mapped on the first write
+#define DEF_OUTFILE(NAME, FD) \
+	ACCMUT_FILE NAME = {O_WRONLY, FD, NULL, NULL, NULL, NULL, 0, NULL, 0, NULL}
 
-DEF_STDFILE(stdfile_0, 0, STDIN_BUFF, LINE_BUF_SIZE, 0);	//unimplemented stdin
-DEF_STDFILE(stdfile_1, 1, STDOUT_BUFF, MAX_STDOUT_BUF_SIZE, O_WRONLY);
-DEF_STDFILE(stdfile_2, 2, STDERR_BUFF, MAX_STDERR_BUF_SIZE, O_WRONLY);
+//stdin is read into memory by __accmut__init_stdstream()
+ACCMUT_FILE stdfile_0 = {O_RDONLY, 0, NULL, NULL, NULL, NULL, 0, NULL, 0, NULL};
+DEF_OUTFILE(stdfile_1, 1);
+DEF_OUTFILE(stdfile_2, 2);
 
 static ACCMUT_FILE* accmut_stdin = &stdfile_0;
 static ACCMUT_FILE* accmut_stdout = &stdfile_1;
@@ -64,12 +99,64 @@ static ACCMUT_FILE* accmut_stderr = &stdfile_2;
 //map stdio fd to its accmut buffer
 static ACCMUT_FILE* STDFD_TO_ACC[ACCMUT_MAX_FILENO] = {0};
 
+/* the buffer of fp, NULL if fp is not virtualized (the wrappers fall back to libc) */
+static ACCMUT_FILE* __accmut__accfp(FILE *fp){
+	if(fp == NULL){
+		return NULL;
+	}
+	int fd = fileno(fp);
+	if(fd < 0 || fd >= ACCMUT_MAX_FILENO){
+		return NULL;
+	}
+	return STDFD_TO_ACC[fd];
+}
+
 
 
 // #define ERRMSG(msg) __real_fprintf(stderr, "%s @ %s->%s():%d\tMID: %d\tTID: %d\n", \
 // 	msg,__FILE__, __FUNCTION__, __LINE__, MUTATION_ID, TEST_ID)
 
 
+/*
+* An output buffer is an anonymous mapping reserved on the first write and
+* grown with mremap when it is full, so the output is never cut. Pages are
+* only committed when written, and a forked child only copies the pages
+* it writes to.
+*/
+static int __accmut__buf_grow(ACCMUT_FILE *fp, size_t len){
+
+	size_t used = fp->write_cur - fp->bufbase;
+	size_t cap = fp->bufend - fp->bufbase;
+	size_t size = cap > 0 ? cap : OUT_BUF_RESERVE;
+	while(size < used + len){
+		size *= 2;
+	}
+
+	char *base;
+	if(fp->bufbase == NULL){
+		base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	}else{
+		base = mremap(fp->bufbase, cap, size, MREMAP_MAYMOVE);
+	}
+	if(base == MAP_FAILED){
+		ERRMSG("OUTPUT BUF mmap ERR");
+		return -1;
+	}
+
+	fp->bufbase = base;
+	fp->write_cur = base + used;
+	fp->bufend = base + size;
+	return 0;
+}
+
+/* make room for len more bytes, 0 if done */
+static inline int __accmut__buf_room(ACCMUT_FILE *fp, size_t len){
+	if((size_t)(fp->bufend - fp->write_cur) >= len){
+		return 0;
+	}
+	return __accmut__buf_grow(fp, len);
+}
+
 #define CHECK_FILE(FILE, RET) \
 	if ((FILE) == NULL) { return RET; } \
 	else { if (((FILE)->_IO_file_flags & _IO_MAGIC_MASK) != _IO_MAGIC) \
@@ -79,26 +166,69 @@ static ACCMUT_FILE* STDFD_TO_ACC[ACCMUT_MAX_FILENO] = {0};
 /*********************** FILE OPTIONS ****************************************/
 
 
+/*
+* A file opened for writing lives in the overlay of accmut_vfs.h. A mutant
+* only opens /dev/null as the handle of the stream, the original also opens
+* the real file and writes it through (see __accmut__vfile_sync). A file of
+* the overlay is read back from memory, an unlinked one is gone.
+* Streams opened for update are left to libc.
+*/
 FILE* __wrap_fopen(const char *path, const char *mode){
-	
-	FILE* fp = fopen(path, mode);
+
+	int writing = (mode[0] == 'w' || mode[0] == 'a');
+
+	AccmutVFile *vf = NULL;
+	if(strchr(mode, '+') == NULL){
+		vf = __accmut__vfs_lookup(path, writing);
+	}
+	if(vf != NULL && !writing){
+		if(vf->deleted){
+			errno = ENOENT;
+			return NULL;
+		}
+		if(!vf->written){
+			vf = NULL;
+		}
+	}
+
+	FILE* fp;
+	if(vf == NULL || (writing && MUTATION_ID == 0)){
+		fp = __real_fopen(path, mode);
+	}else{
+		fp = __real_fopen("/dev/null", writing ? "w" : "r");
+	}
 
 	if(fp == NULL){
 		return NULL;
 	}
 
-	setvbuf(fp, NULL, _IONBF, 0);
-
 	int _fd = fileno(fp);
 
-	ACCMUT_FILE *acc_fp = (ACCMUT_FILE *)malloc(sizeof(ACCMUT_FILE));
+	//read and write at the same time, left to libc
+	if((fp->_flags & (_IO_NO_WRITES | _IO_NO_READS)) == 0 || _fd >= ACCMUT_MAX_FILENO){
+		return fp;
+	}
+
+	setvbuf(fp, NULL, _IONBF, 0);
+
+	ACCMUT_FILE *acc_fp = (ACCMUT_FILE *)calloc(1, sizeof(ACCMUT_FILE));
 
 	if(acc_fp == NULL){
 		ERRMSG("malloc ACCMUT_FILE ERR");
 		exit(FOPEN_ERR);
 	}
 
-	if(fp->_flags & _IO_NO_WRITES){//the readonly file
+	acc_fp->fd = _fd;
+	acc_fp->vfile = vf;
+
+	if(!writing && vf != NULL){//read back from the overlay
+
+		acc_fp->flags = O_RDONLY;
+		acc_fp->bufbase = acc_fp->read_cur = vf->base;
+		acc_fp->fsize = vf->len;
+		acc_fp->bufend = acc_fp->bufbase + acc_fp->fsize;
+
+	}else if(!writing){//the readonly file
 
 		struct stat sb;
 		if(fstat(_fd, &sb) == -1){
@@ -114,20 +244,57 @@ FILE* __wrap_fopen(const char *path, const char *mode){
 			return NULL;
 		}
 		acc_fp->flags = O_RDONLY;
-		acc_fp->fd = _fd;
-		acc_fp->bufbase = acc_fp->read_cur = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, _fd, 0);
-		acc_fp->write_cur = NULL;
+		//writable for ungetc, a private copy of the page is made then
+		acc_fp->bufbase = acc_fp->read_cur = sb.st_size > 0 ?
+			mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _fd, 0) : NULL;
+		if(acc_fp->bufbase == MAP_FAILED){
+			ERRMSG("mmap INPUT FILE ERR");
+			exit(ENV_ERR);
+		}
 		acc_fp->fsize = sb.st_size;
 		acc_fp->bufend = acc_fp->bufbase + acc_fp->fsize;
 
-	}else if(fp->_flags & _IO_NO_READS){
+	}else{
 
 		acc_fp->flags = O_WRONLY;
-		acc_fp->fd = _fd;
-		acc_fp->bufbase = acc_fp->write_cur = (char*) calloc(1, MAX_FILE_BUF_SIZE*(sizeof(char)) );
-		acc_fp->read_cur = NULL;
-		acc_fp->fsize = 0;
-		acc_fp->bufend = acc_fp->bufbase + MAX_FILE_BUF_SIZE*(sizeof(char));
+
+		int load = 0;
+		if(mode[0] == 'w' || vf->deleted){
+			if(vf->base != NULL && vf->len > 0){
+				madvise(vf->base, vf->len, MADV_DONTNEED);
+			}
+			vf->len = 0;
+		}else if(!vf->written){
+			//appending to a file that is not in memory yet
+			load = 1;
+		}
+		vf->deleted = 0;
+		vf->written = 1;
+
+		acc_fp->bufbase = vf->base;
+		acc_fp->write_cur = vf->base + vf->len;
+		acc_fp->bufend = vf->base + vf->cap;
+
+		if(load){
+			int rfd = open(path, O_RDONLY);
+			struct stat sb;
+			if(rfd >= 0 && fstat(rfd, &sb) == 0 && sb.st_size > 0
+					&& __accmut__buf_room(acc_fp, sb.st_size) == 0){
+				ssize_t n = read(rfd, acc_fp->write_cur, sb.st_size);
+				if(n > 0){
+					acc_fp->write_cur += n;
+				}
+			}
+			if(rfd >= 0){
+				close(rfd);
+			}
+		}
+
+		//what the original appends to is already on disk
+		acc_fp->synced = mode[0] == 'a' ? acc_fp->write_cur - acc_fp->bufbase : 0;
+		vf->base = acc_fp->bufbase;
+		vf->len = acc_fp->write_cur - acc_fp->bufbase;
+		vf->cap = acc_fp->bufend - acc_fp->bufbase;
 	}
 
 	STDFD_TO_ACC[_fd] = acc_fp;
@@ -135,22 +302,104 @@ FILE* __wrap_fopen(const char *path, const char *mode){
 	return fp;
 }
 
+/*
+* Only the original writes to the real fds: the bytes of the buffer not
+* written yet go out, the mutants keep everything in memory.
+*/
+static void __accmut__write_through(ACCMUT_FILE *acc_fp){
+
+	if(MUTATION_ID != 0){
+		return;
+	}
+	size_t len = acc_fp->write_cur - acc_fp->bufbase;
+	while(acc_fp->synced < len){
+		ssize_t n = write(acc_fp->fd, acc_fp->bufbase + acc_fp->synced, len - acc_fp->synced);
+		if(n < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			ERRMSG("WRITE THROUGH ERR");
+			break;
+		}
+		acc_fp->synced += n;
+	}
+}
+
+/* hand the output of an open file to its overlay entry, in memory only */
+static void __accmut__vfile_update(ACCMUT_FILE *acc_fp){
+	AccmutVFile *vf = acc_fp->vfile;
+	vf->base = acc_fp->bufbase;
+	vf->len = acc_fp->write_cur - acc_fp->bufbase;
+	vf->cap = acc_fp->bufend - acc_fp->bufbase;
+}
+
+/* the overlay entry is up to date, the original also writes the new bytes to the real file */
+static void __accmut__vfile_sync(ACCMUT_FILE *acc_fp){
+	__accmut__vfile_update(acc_fp);
+	__accmut__write_through(acc_fp);
+}
+
+static void __accmut__vfile_sync_all(){
+	int i;
+	for(i = 0; i < ACCMUT_MAX_FILENO; i++){
+		ACCMUT_FILE *acc_fp = STDFD_TO_ACC[i];
+		if(acc_fp != NULL && acc_fp->vfile != NULL && (acc_fp->flags & O_WRONLY)){
+			__accmut__vfile_sync(acc_fp);
+		}
+	}
+}
+
+/* the files as this process sees them, the files still open included */
+unsigned long __accmut__files_digest(){
+	int i;
+	for(i = 0; i < ACCMUT_MAX_FILENO; i++){
+		ACCMUT_FILE *acc_fp = STDFD_TO_ACC[i];
+		if(acc_fp != NULL && acc_fp->vfile != NULL && (acc_fp->flags & O_WRONLY)){
+			__accmut__vfile_update(acc_fp);
+		}
+	}
+	return __accmut__vfs_digest();
+}
+
+static void __accmut__std_write_through(){
+	if(STDFD_TO_ACC[1] == accmut_stdout){
+		__accmut__write_through(accmut_stdout);
+	}
+	if(STDFD_TO_ACC[2] == accmut_stderr){
+		__accmut__write_through(accmut_stderr);
+	}
+}
+
 static void __accmut__reset_stdfp(ACCMUT_FILE *fp){
+	if(fp->flags == O_WRONLY && fp->write_cur > fp->bufbase){
+		//give the written pages back, the mapping stays
+		madvise(fp->bufbase, fp->write_cur - fp->bufbase, MADV_DONTNEED);
+	}
 	fp->read_cur = fp->write_cur = fp->bufbase;
 	fp->fsize = 0;
+	fp->synced = 0;
+	if(fp == accmut_stdout){
+		ORACLE_CHECKED = 0;
+	}
 }
 
 int __wrap_fclose(FILE *fp){
 	if(fp == NULL){
-		fclose(fp);
 		return EOF;
 	}
 
 	int _fd = fileno(fp);
 
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[_fd];
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_fclose(fp);
+	}
 
 	if(fp == stdout || fp == stderr || fp == stdin){
+		if(acc_fp->flags == O_WRONLY){
+			__accmut__write_through(acc_fp);
+		}
 		__accmut__reset_stdfp(acc_fp);
 		STDFD_TO_ACC[_fd] = NULL;
 	}else{
@@ -162,52 +411,179 @@ int __wrap_fclose(FILE *fp){
 			}
 		#endif
 
-		if(acc_fp->flags & O_RDONLY){
-			int status = munmap(acc_fp->bufbase, acc_fp->fsize);
-			if(status < 0){
-				ERRMSG("munmap ERROR");
-				exit(ENV_ERR);
+		if(acc_fp->vfile != NULL){
+			//the overlay keeps the content
+			if(acc_fp->flags & O_WRONLY){
+				__accmut__vfile_sync(acc_fp);
 			}
-			free(acc_fp);
-			STDFD_TO_ACC[_fd] = NULL;
-		}else if(acc_fp->flags & O_WRONLY){
-			free(acc_fp->bufbase);
-			free(acc_fp);
+			free(acc_fp->copy);
+		}else if(acc_fp->bufbase != NULL && acc_fp->fsize > 0
+				&& munmap(acc_fp->bufbase, acc_fp->fsize) < 0){
+			ERRMSG("munmap ERROR");
+			exit(ENV_ERR);
 		}
+		free(acc_fp);
+		STDFD_TO_ACC[_fd] = NULL;
 
 	}
-	return fclose(fp);
+	return __real_fclose(fp);
 }
 
-#if 0
-
-//TODO: unmodified
 int __wrap_feof(FILE *fp){
 
-	if(fp == NULL){
-		return EOF;
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_feof(fp);
 	}
-	if((fp->flags & O_RDONLY) == 0){
-		#if ACCMUT_IO_DEBUG
-		fprintf(stderr, "OPLY SUPPORT O_RDONLY MODE @__wrap_feof\n");
-		#endif
-		return EOF;
+
+	return (acc_fp->flags & _IO_EOF_SEEN) != 0;
+}
+
+int __wrap_ferror(FILE *fp){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_ferror(fp);
 	}
 
-	int result = (fp->flags & _IO_EOF_SEEN) != 0;
-	return result;
+	return (acc_fp->flags & _IO_ERR_SEEN) != 0;
+}
+
+void __wrap_clearerr(FILE *fp){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		__real_clearerr(fp);
+		return;
+	}
+
+	acc_fp->flags &= ~(_IO_EOF_SEEN | _IO_ERR_SEEN);
 }
 
-int __wrap_fseek(FILE *fp, size_t offset, int loc){
-	//TODO
+/*
+* An input file can be positioned anywhere, reading past its end only sees
+* EOF. An output file only grows at its end, so it can only be "moved" to
+* where it already is.
+*/
+int __wrap_fseek(FILE *fp, long offset, int loc){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_fseek(fp, offset, loc);
+	}
+
+	long cur, end;
+	if(acc_fp->flags & O_WRONLY){
+		cur = end = acc_fp->write_cur - acc_fp->bufbase;
+	}else{
+		cur = acc_fp->read_cur - acc_fp->bufbase;
+		end = acc_fp->fsize;
+	}
+
+	long pos;
+	switch(loc){
+		case SEEK_SET:
+			pos = offset;
+			break;
+		case SEEK_CUR:
+			pos = cur + offset;
+			break;
+		case SEEK_END:
+			pos = end + offset;
+			break;
+		default:
+			errno = EINVAL;
+			return -1;
+	}
+
+	if(pos < 0 || ((acc_fp->flags & O_WRONLY) && pos != end)){
+		errno = EINVAL;
+		return -1;
+	}
+
+	if((acc_fp->flags & O_WRONLY) == 0){
+		acc_fp->read_cur = acc_fp->bufbase + (pos < end ? pos : end);
+	}
+	acc_fp->flags &= ~_IO_EOF_SEEN;
 	return 0;
 }
 
-int __wrap_ferror(FILE *fp){
-	//TODO:
+long __wrap_ftell(FILE *fp){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_ftell(fp);
+	}
+
+	if(acc_fp->flags & O_WRONLY){
+		return acc_fp->write_cur - acc_fp->bufbase;
+	}
+	return acc_fp->read_cur - acc_fp->bufbase;
+}
+
+void __wrap_rewind(FILE *fp){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		__real_rewind(fp);
+		return;
+	}
+
+	if((acc_fp->flags & O_WRONLY) == 0){
+		acc_fp->read_cur = acc_fp->bufbase;
+	}
+	acc_fp->flags &= ~(_IO_EOF_SEEN | _IO_ERR_SEEN);
+}
+
+int __wrap_fgetpos(FILE *fp, fpos_t *pos){
+
+	if(__accmut__accfp(fp) == NULL){
+		return __real_fgetpos(fp, pos);
+	}
+
+	long off = __wrap_ftell(fp);
+	if(off < 0){
+		return -1;
+	}
+	memset(pos, 0, sizeof(fpos_t));
+	pos->__pos = off;
 	return 0;
 }
 
+int __wrap_fsetpos(FILE *fp, const fpos_t *pos){
+
+	if(__accmut__accfp(fp) == NULL){
+		return __real_fsetpos(fp, pos);
+	}
+
+	return __wrap_fseek(fp, pos->__pos, SEEK_SET);
+}
+
+int __wrap_fflush(FILE *fp){
+
+	//all the output stays in the buffers, the original writes stdout and stderr out
+	if(fp == NULL){
+		__accmut__std_write_through();
+		return __real_fflush(NULL);
+	}
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+	if(acc_fp != NULL){
+		if(acc_fp == accmut_stdout || acc_fp == accmut_stderr){
+			__accmut__write_through(acc_fp);
+		}
+		return 0;
+	}
+	return __real_fflush(fp);
+}
+
+#if 0
+
 int __wrap_fileno(FILE *fp){
 	return fileno(fp);
 }
@@ -263,8 +639,10 @@ FILE * __wrap_freopen(const char *path, const char *mode, FILE *fp){
 /*********************** POSIX FILE ****************************************/
 int __wrap_unlink(const char *pathname){
 
+	__accmut__vfs_unlink(pathname);
+
 	if(MUTATION_ID == 0){// only main process can unlink the tmp file
-		return unlink(pathname);
+		return __real_unlink(pathname);
 	}else{
 		return 0;
 	}
@@ -272,35 +650,29 @@ int __wrap_unlink(const char *pathname){
 
 /*********************** INPUT ****************************************/
 
+/* the bytes left to read */
+#define ACC_LEFT(acc_fp) ((size_t)((acc_fp)->bufbase + (acc_fp)->fsize - (acc_fp)->read_cur))
+
 char* __wrap_fgets(char *buf, int size, FILE *fp){
 
 	if(size <= 0)
 		return NULL;
 
-	int fd = fileno(fp);
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
 
-	if(fd < 0){
-		return NULL;
+	if(acc_fp == NULL){
+		return __real_fgets(buf, size, fp);
 	}
 
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
-
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
-		}
-	#endif
-
-	if(acc_fp->read_cur - acc_fp->bufbase >= acc_fp->fsize){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("READ OVERFLOW");
-		#endif
+	if(ACC_LEFT(acc_fp) == 0){
 		acc_fp->flags |= _IO_EOF_SEEN;
 		return NULL;
 	}
 	
 	size_t len = size - 1;
+	if(len > ACC_LEFT(acc_fp)){
+		len = ACC_LEFT(acc_fp);
+	}
 	
 	char *t = (char*) memchr((void*) acc_fp->read_cur, '\n', len);
 	
@@ -323,138 +695,265 @@ char* __wrap_fgets(char *buf, int size, FILE *fp){
 	return buf;
 }
 
-int __wrap_getc(FILE *fp){
+int __wrap_fgetc(FILE *fp){
 
-	int fd = fileno(fp);
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
 
-	if(fd < 0){
+	if(acc_fp == NULL){
+		return __real_fgetc(fp);
+	}
+
+	if(ACC_LEFT(acc_fp) == 0){
+		acc_fp->flags |= _IO_EOF_SEEN;
 		return EOF;
 	}
 
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
+	return  *((unsigned char *) acc_fp->read_cur++);
+}
 
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
-		}
-	#endif
+int __wrap_getc(FILE *fp){
+	return __wrap_fgetc(fp);
+}
 
-	if(acc_fp->read_cur - acc_fp->bufbase >= acc_fp->fsize){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("READ OVERFLOW");		
-		#endif
-		acc_fp->flags |= _IO_EOF_SEEN;
+int __wrap_getchar(){
+	return __wrap_fgetc(stdin);
+}
+
+/*
+* A file read back from the overlay reads the buffer of its entry. Before a
+* different byte is pushed back the stream gets a private copy, the content
+* of the file stays as written.
+*/
+static int __accmut__unshare(ACCMUT_FILE *acc_fp){
+	if(acc_fp->copy != NULL){
+		return 0;
+	}
+	acc_fp->copy = (char *)malloc(acc_fp->fsize);
+	if(acc_fp->copy == NULL){
+		ERRMSG("malloc UNGETC COPY ERR");
+		return -1;
+	}
+	memcpy(acc_fp->copy, acc_fp->bufbase, acc_fp->fsize);
+	acc_fp->read_cur = acc_fp->copy + (acc_fp->read_cur - acc_fp->bufbase);
+	acc_fp->bufbase = acc_fp->copy;
+	acc_fp->bufend = acc_fp->copy + acc_fp->fsize;
+	return 0;
+}
+
+int __wrap_ungetc(int c, FILE *fp){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_ungetc(c, fp);
+	}
+
+	//only what has been read can be pushed back
+	if(c == EOF || acc_fp->read_cur == acc_fp->bufbase){
 		return EOF;
 	}
 
-	return  *((unsigned char *) acc_fp->read_cur++);
+	if(*((unsigned char *) acc_fp->read_cur - 1) != (unsigned char) c
+			&& acc_fp->vfile != NULL && __accmut__unshare(acc_fp) != 0){
+		return EOF;
+	}
+	acc_fp->read_cur--;
+	*(acc_fp->read_cur) = c;
+	acc_fp->flags &= ~_IO_EOF_SEEN;
+	return (unsigned char) c;
 }
 
 size_t __wrap_fread(void *buf, size_t size, size_t count, FILE *fp){
 
-	int fd = fileno(fp);
-	
-	if(fd < 0){
-		return 0;
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_fread(buf, size, count, fp);
 	}
 
-	_IO_size_t bytes_requested = size * count;
+	size_t bytes_requested = size * count;
 
 	if (bytes_requested == 0)
     	return 0;
-   
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
-
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
-		}
-	#endif
 
     char *s = buf;
 
-    if(acc_fp->read_cur + bytes_requested > acc_fp->bufend){
-
-  		#if ACCMUT_IO_DEBUG
-			ERRMSG("READ OVERFLOW");
-		#endif
-		
-    	memcpy(s, acc_fp->read_cur, acc_fp->bufend - acc_fp->read_cur);
-    	int res = (acc_fp->bufend - acc_fp->read_cur)/size;
-    	acc_fp->read_cur = acc_fp->bufend;
-    	acc_fp->flags |= _IO_EOF_SEEN;
-    	return res;
+    if(bytes_requested > ACC_LEFT(acc_fp)){
+		//the rest is consumed, only the whole items count
+		size_t res = ACC_LEFT(acc_fp) / size;
+		memcpy(s, acc_fp->read_cur, ACC_LEFT(acc_fp));
+		acc_fp->read_cur += ACC_LEFT(acc_fp);
+		acc_fp->flags |= _IO_EOF_SEEN;
+		return res;
     }
     memcpy(s, acc_fp->read_cur, bytes_requested);
     acc_fp->read_cur += bytes_requested;
     return count;
 }
 
+/*
+* The scanf family scans the rest of the buffer through a memory stream,
+* and moves the buffer by what the stream has consumed.
+*/
+static int __accmut__vscanf(ACCMUT_FILE *acc_fp, const char *format, va_list ap){
+
+	if(ACC_LEFT(acc_fp) == 0){
+		acc_fp->flags |= _IO_EOF_SEEN;
+		return EOF;
+	}
+
+	FILE *m = fmemopen(acc_fp->read_cur, ACC_LEFT(acc_fp), "r");
+	if(m == NULL){
+		ERRMSG("fmemopen ERR");
+		exit(ENV_ERR);
+	}
+
+	int ret = vfscanf(m, format, ap);
+
+	long used = __real_ftell(m);
+	if(used > 0){
+		acc_fp->read_cur += used;
+	}
+	if(ACC_LEFT(acc_fp) == 0){
+		acc_fp->flags |= _IO_EOF_SEEN;
+	}
+	__real_fclose(m);
+	return ret;
+}
+
+int __wrap_fscanf(FILE *fp, const char *format, ...){
+
+	int ret;
+	va_list ap;
+	va_start(ap, format);
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+	if(acc_fp == NULL){
+		ret = vfscanf(fp, format, ap);
+	}else{
+		ret = __accmut__vscanf(acc_fp, format, ap);
+	}
+	va_end(ap);
+	return ret;
+}
+
+int __wrap_scanf(const char *format, ...){
+
+	int ret;
+	va_list ap;
+	va_start(ap, format);
+	ACCMUT_FILE* acc_fp = __accmut__accfp(stdin);
+	if(acc_fp == NULL){
+		ret = vscanf(format, ap);
+	}else{
+		ret = __accmut__vscanf(acc_fp, format, ap);
+	}
+	va_end(ap);
+	return ret;
+}
+
+//in C99 mode the scanf calls go to the __isoc99_ symbols of glibc
+int __wrap___isoc99_fscanf(FILE *fp, const char *format, ...) __attribute__((alias("__wrap_fscanf")));
+
+int __wrap___isoc99_scanf(const char *format, ...) __attribute__((alias("__wrap_scanf")));
+
+//getc and putc of older glibc are macros of these
+int __wrap__IO_getc(FILE *fp) __attribute__((alias("__wrap_getc")));
+
 /*********************** OUTPUT ****************************************/
 
-int __wrap_fputc(int c, FILE *fp){
+/*
+* Compare the new bytes of stdout with the oracle as soon as they are
+* written. A mutant diverging from the oracle, or writing past its end,
+* is killed right away instead of running to the end (or to the timeout).
+* The original process never checks, it is the oracle.
+*/
+static void __accmut__stream_check(ACCMUT_FILE *fp){
 
-	int fd = fileno(fp);
+	if(fp != accmut_stdout || ORACLEBUFF == NULL || MUTATION_ID == 0){
+		return;
+	}
 
-	if(fd < 0){
-		return EOF;
+	size_t cur = fp->write_cur - fp->bufbase;
+
+	if(cur > ORACLESIZE || memcmp(fp->bufbase + ORACLE_CHECKED,
+			ORACLEBUFF + ORACLE_CHECKED, cur - ORACLE_CHECKED) != 0){
+		__accmut__result_abort(OUT_KILLED, OUTPUT_ERR);
+		__accmut__sched_release();
+		_exit(OUTPUT_ERR);
 	}
 
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
+	ORACLE_CHECKED = cur;
+}
 
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
+/* format into the buffer, growing it when the output does not fit */
+static int __accmut__vprintf(ACCMUT_FILE *fp, const char *format, va_list ap){
+	va_list again;
+	va_copy(again, ap);
+
+	size_t room = fp->bufend - fp->write_cur;
+	int ret = vsnprintf(fp->write_cur, room, format, ap);
+	if(ret >= 0 && (size_t)ret >= room){
+		if(__accmut__buf_room(fp, ret + 1) != 0){
+			va_end(again);
+			return 0;
 		}
-	#endif
+		vsnprintf(fp->write_cur, ret + 1, format, again);
+	}
+	va_end(again);
 
-	if(acc_fp->write_cur >= acc_fp->bufend){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("WRITE OVERFLOW");
-		#endif
-		//TODO: need something to fflush
+	if(ret < 0){
+		return ret;
+	}
+
+	fp->write_cur += ret;
+	__accmut__stream_check(fp);
+	return ret;
+}
+
+int __wrap_fputc(int c, FILE *fp){
+
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_fputc(c, fp);
+	}
+
+	if(__accmut__buf_room(acc_fp, 1) != 0){
 		return EOF;
 	}
 	// fp->fsize++;
 	*(acc_fp->write_cur) = c;
 	(acc_fp->write_cur)++;
+	__accmut__stream_check(acc_fp);
 	return (unsigned char) c;
 }
-//putc implemented as a macro 
-// TODO: check for __wrap
-#define __wrap_putc(c, f) ( __wrap_fputc(c, f) )
 
+int __wrap_putc(int c, FILE *fp){
+	return __wrap_fputc(c, fp);
+}
 
-int __wrap_fputs(const char* s, FILE *fp){
+int __wrap_putchar(int c){
+	return __wrap_fputc(c, stdout);
+}
 
-	int fd = fileno(fp);
+int __wrap__IO_putc(int c, FILE *fp) __attribute__((alias("__wrap_putc")));
 
-	if(fd < 0){
-		return EOF;
-	}
 
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
+int __wrap_fputs(const char* s, FILE *fp){
 
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
-		}
-	#endif
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_fputs(s, fp);
+	}
 
 	int result = EOF;
 	size_t len = strlen(s);
-	if(acc_fp->write_cur + len >= acc_fp->bufend){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("WRITE OVERFLOW");
-		#endif
-	}else{
+	if(__accmut__buf_room(acc_fp, len) == 0){
 		memcpy(acc_fp->write_cur, s, len);
 		acc_fp->write_cur += len;
 		// fp->fsize += len;
+		__accmut__stream_check(acc_fp);
 		result = 1;	
 	}
 	return result;
@@ -466,15 +965,12 @@ int __wrap_puts(const char* s){
 
 	int result = EOF;
 
-	if( (accmut_stdout->write_cur + len + 1) >= accmut_stdout->bufend){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("accmut_stdout WRITE OVERFLOW");
-		#endif
-	}else{
+	if(__accmut__buf_room(accmut_stdout, len + 1) == 0){
 		memcpy(accmut_stdout->write_cur, s, len);		
 		accmut_stdout->write_cur += len;
 		*accmut_stdout->write_cur = '\n';
 		accmut_stdout->write_cur++;
+		__accmut__stream_check(accmut_stdout);
 		result = 1;	
 	}
 	return result;
@@ -482,55 +978,17 @@ int __wrap_puts(const char* s){
 
 int __wrap_fprintf(FILE *fp, const char *format, ...){
 
-	// ERRMSG("ERRMSG\n");
-	// return __real_fprintf(stderr, "__wrap_fprintf !!!!!!!\n");
-
-
-	int fd = fileno(fp);
-
-	if(fd < 0){
-		return EOF;
-	}
-
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
-
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
-		}
-	#endif
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
 
 	int ret;
 	va_list ap;
 	va_start(ap, format);
-	ret = vsprintf(acc_fp->write_cur, format, ap);	//TODO:: use (STDOUT_BUFF + CUR_STDOUT) instead of tmp
-	va_end(ap);
-
-	int max;
-	switch(fd){
-		case 0:
-			max = 0;
-			break;
-		case 1:
-			max = MAX_STDOUT_BUF_SIZE;
-			break;
-		case 2:
-			max = MAX_STDERR_BUF_SIZE;
-			break;
-		default:
-			max = MAX_FILE_BUF_SIZE;
-			break;
-	}
-
-	if((acc_fp->write_cur - acc_fp->bufbase) + ret  > max){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("WRITE OVERFLOW");
-		#endif
-		return 0;
+	if(acc_fp == NULL){
+		ret = __real_vfprintf(fp, format, ap);
+	}else{
+		ret = __accmut__vprintf(acc_fp, format, ap);
 	}
-
-	acc_fp->write_cur += ret;
+	va_end(ap);
 
 	return ret;
 }
@@ -539,64 +997,133 @@ int __wrap_printf(const char *format, ...){
 	int ret;
 	va_list ap;
 	va_start(ap, format);
-	ret = vsprintf(accmut_stdout->write_cur, format, ap);	//TODO:: use (STDOUT_BUFF + CUR_STDOUT) instead of tmp
+	ret = __accmut__vprintf(accmut_stdout, format, ap);
 	va_end(ap);
 
-	if((accmut_stdout->write_cur - accmut_stdout->bufbase) + ret  > MAX_STDOUT_BUF_SIZE){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("WRITE OVERFLOW");
-		#endif
-		return 0;
-	}
-
-	accmut_stdout->write_cur += ret;
 	return ret;
 }
 
-size_t __wrap_fwrite(const void *buf, size_t size, size_t count, FILE *fp){
+int __wrap_vfprintf(FILE *fp, const char *format, va_list ap){
 
-	int fd = fileno(fp);
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
 
-	if(fd < 0){
-		return EOF;
+	if(acc_fp == NULL){
+		return __real_vfprintf(fp, format, ap);
 	}
+	return __accmut__vprintf(acc_fp, format, ap);
+}
 
-	ACCMUT_FILE* acc_fp = STDFD_TO_ACC[fd];
+int __wrap_vprintf(const char *format, va_list ap){
+	return __accmut__vprintf(accmut_stdout, format, ap);
+}
 
-	#if ACCMUT_IO_DEBUG
-		if(acc_fp == NULL){
-			ERRMSG("acc_fp SHOULD NOT BE NULL");
-			exit(ILL_STATE_ERR);
-		}
-	#endif
+size_t __wrap_fwrite(const void *buf, size_t size, size_t count, FILE *fp){
 
-	int request = size*count;
-	if(acc_fp->write_cur + request > acc_fp->bufend){
-		#if ACCMUT_IO_DEBUG
-			ERRMSG("WRITE OVERFLOW");
-		#endif
+	ACCMUT_FILE* acc_fp = __accmut__accfp(fp);
+
+	if(acc_fp == NULL){
+		return __real_fwrite(buf, size, count, fp);
+	}
+
+	size_t request = size*count;
+	if(__accmut__buf_room(acc_fp, request) != 0){
 		return 0;
 	}
 	char *s = (char *) buf;
 	memcpy(acc_fp->write_cur, s, request);
 	acc_fp->write_cur += request;
+	__accmut__stream_check(acc_fp);
 	return count;
 }
 
 
 
 /*********************** BUF UTILS ****************************************/
+/*
+* Read stdin into memory, once in the main process before the first fork, so
+* the mutants read their own copy instead of the shared file offset.
+* A regular file is mapped, a pipe is read to its end. Anything else
+* (a terminal, a socket, /dev/null) is left to libc. 0 if stdin is in memory.
+*/
+static int __accmut__stdin_init(){
+
+	ACCMUT_FILE *acc_fp = accmut_stdin;
+	struct stat sb;
+	if(fstat(STDIN_FILENO, &sb) < 0 || !(S_ISREG(sb.st_mode) || S_ISFIFO(sb.st_mode))){
+		return -1;
+	}
+
+	if(S_ISREG(sb.st_mode)){
+		off_t off = lseek(STDIN_FILENO, 0, SEEK_CUR);
+		if(sb.st_size > 0){
+			acc_fp->bufbase = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, STDIN_FILENO, 0);
+			if(acc_fp->bufbase == MAP_FAILED){
+				acc_fp->bufbase = NULL;
+				return -1;
+			}
+		}
+		acc_fp->fsize = sb.st_size;
+		acc_fp->read_cur = acc_fp->bufbase + (off > 0 && off < sb.st_size ? off : 0);
+	}else{
+		size_t cap = LINE_BUF_SIZE, len = 0;
+		char *buf = (char *)malloc(cap);
+		ssize_t n;
+		while(buf != NULL && (n = read(STDIN_FILENO, buf + len, cap - len)) != 0){
+			if(n < 0){
+				if(errno == EINTR){
+					continue;
+				}
+				break;
+			}
+			len += n;
+			if(len == cap){
+				cap *= 2;
+				buf = (char *)realloc(buf, cap);
+			}
+		}
+		if(buf == NULL){
+			ERRMSG("malloc STDIN ERR");
+			exit(MELLOC_ERR);
+		}
+		acc_fp->bufbase = acc_fp->read_cur = buf;
+		acc_fp->fsize = len;
+	}
+	acc_fp->bufend = acc_fp->bufbase + acc_fp->fsize;
+	return 0;
+}
+
+/* the files still open at exit, and the stdout and stderr of the original */
+static void __accmut__io_exit(){
+	__accmut__vfile_sync_all();
+	__accmut__std_write_through();
+}
+
 void __accmut__init_stdstream(){
-	STDFD_TO_ACC[0] = accmut_stdin;
+	if(atexit(__accmut__io_exit) != 0){
+		ERRMSG("atexit ERR");
+		exit(ENV_ERR);
+	}
+
+	if(__accmut__stdin_init() == 0){
+		STDFD_TO_ACC[0] = accmut_stdin;
+	}
 	STDFD_TO_ACC[1] = accmut_stdout;
 	STDFD_TO_ACC[2] = accmut_stderr;
+
+	__accmut__oracal_bufinit();
 }
 
 int __accmut__checkoutput(){
-	if(ORACLESIZE != CUR_STDOUT){
+	//the files are compared by the original, see __accmut__result_on_exit
+	//no oracle, nothing to compare with
+	if(ORACLEBUFF == NULL){
+		return 0;
+	}
+	size_t cur = accmut_stdout->write_cur - accmut_stdout->bufbase;
+	if(ORACLESIZE != cur){
 		return 1;
 	}
-	return memcmp(STDOUT_BUFF, ORACLEBUFF, CUR_STDOUT);
+	return cur > 0 ? memcmp(accmut_stdout->bufbase, ORACLEBUFF, cur) : 0;
 }
 
 #define fprintf __real_fprintf
@@ -604,7 +1131,12 @@ int __accmut__checkoutput(){
 void __accmut__exit_check_output(){
 	int res = __accmut__checkoutput();
 	if(res != 0){
-		fprintf(stderr, "TEST: %d KILL MUT: %d\n", TEST_ID, MUTATION_ID);
+		const int *muts;
+		int num = __accmut__represented_muts(&muts);
+		int i;
+		for(i = 0; i < num; i++){
+			fprintf(stderr, "TEST: %d KILL MUT: %d\n", TEST_ID, muts[i]);
+		}
 		//__accmut__filedump();
 		
 	}
@@ -615,22 +1147,32 @@ void __accmut__exit_check_output(){
 }
 
 void __accmut__oracal_bufinit(){
-	char path[120];
-	sprintf(path, "%st%d", ORACLEDIR, TEST_ID);
+	char path[256];
+	sprintf(path, "%s%s%s/t%d", getenv("HOME"), "/tmp/accmut/oracle/", PROJECT, TEST_ID);
 	int fd = open(path, O_RDONLY);
 	if(fd == -1){
+		#if 0
 		fprintf(stderr, "ORACLEDIR OPEN ERROR !!!!!!\n");
 		fprintf(stderr, "ORACLEDIR PATH : %s\n", path);
+		#endif
+		return;
 	}
 	struct stat sb;
 	if(fstat(fd, &sb) == -1){
 		fprintf(stderr, "fstat ERROR !!!!!!\n");
+		close(fd);
+		return;
 	}
-	ORACLEBUFF = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	ORACLESIZE = sb.st_size;
+	//mmap fails on an empty oracle, any output kills then
+	ORACLEBUFF = sb.st_size > 0 ? mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : EMPTY_ORACLE;
+	close(fd);
 	if(ORACLEBUFF == MAP_FAILED){
 		fprintf(stderr, "mmap ERROR !!!!!!\n");
+		ORACLEBUFF = NULL;
+		ORACLESIZE = 0;
+		return;
 	}
-	ORACLESIZE = sb.st_size;
 
 	//regist the exit handler function of a process
 	if(atexit(__accmut__exit_check_output) != 0){
@@ -9,18 +9,18 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <stdarg.h>
 
 #include "accmut_config.h"
+#include "accmut_vfs.h"
 
 /*************************************************/
 
 //INPUT BUF
 #define MAX_IN_BUF_SIZE (1<<22)
 
-//4M OUTPUT BUF 
-#define MAX_STDOUT_BUF_SIZE (1<<22)
-#define MAX_STDERR_BUF_SIZE (1<<22)
-#define MAX_FILE_BUF_SIZE (1<<22)
+//OUTPUT BUF, the first reservation, doubled when full
+#define OUT_BUF_RESERVE (1UL<<22)
 #define LINE_BUF_SIZE (4096)
 /*************************************************/
 
@@ -35,6 +35,9 @@ typedef struct _ACCMUT_FILE{
 	char *read_cur;
 	char *write_cur;
 	size_t fsize;	//only for input file
+	AccmutVFile *vfile;	//the overlay entry of the file, NULL for the std streams
+	size_t synced;	//the bytes the original has written to the fd
+	char *copy;		//the private copy of an overlay entry read back, see __wrap_ungetc
 	
 }ACCMUT_FILE;
 
@@ -52,10 +55,22 @@ int __wrap_fclose(FILE *fp);
 
 int __wrap_feof(FILE *fp);
 
-int __wrap_fseek(FILE *fp, size_t offset, int loc);
+int __wrap_fseek(FILE *fp, long offset, int loc);
+
+long __wrap_ftell(FILE *fp);
+
+void __wrap_rewind(FILE *fp);
+
+int __wrap_fgetpos(FILE *fp, fpos_t *pos);
+
+int __wrap_fsetpos(FILE *fp, const fpos_t *pos);
 
 int __wrap_ferror(FILE *fp);
 
+void __wrap_clearerr(FILE *fp);
+
+int __wrap_fflush(FILE *fp);
+
 int __wrap_fileno(FILE *fp);
 
 FILE * __wrap_freopen(const char *path, const char *mode, FILE *fp);
@@ -67,16 +82,27 @@ int __wrap_unlink(const char *pathname);
 
 char* __wrap_fgets(char *buf, int size, FILE *fp);
 
+int __wrap_fgetc(FILE *fp);
+
 int __wrap_getc(FILE *fp);
 
+int __wrap_getchar();
+
+int __wrap_ungetc(int c, FILE *fp);
+
 size_t __wrap_fread(void *buf, size_t size, size_t count, FILE *fp);
 
+int __wrap_fscanf(FILE *fp, const char *format, ...);
+
+int __wrap_scanf(const char *format, ...);
+
 /*********************** OUTPUT ****************************************/
 
 int __wrap_fputc(int c, FILE *fp);
 
-//TODO
-#define __accmut__putc(c, f) ( __wrap_fputc(c, f) )
+int __wrap_putc(int c, FILE *fp);
+
+int __wrap_putchar(int c);
 
 int __wrap_fputs(const char* s, FILE *fp);
 
@@ -89,6 +115,10 @@ int __wrap_fprintf(FILE *fp, const char *format, ...);
 
 int __wrap_printf(const char *format, ...);
 
+int __wrap_vfprintf(FILE *fp, const char *format, va_list ap);
+
+int __wrap_vprintf(const char *format, va_list ap);
+
 size_t __wrap_fwrite(const void *buf, size_t size, size_t count, FILE *fp);
 
 
@@ -0,0 +1,306 @@
+#include "accmut_mutdb.h"
+
+static const char *MUT_TYPE_NAME[] = {"AOR", "LOR", "COR", "ROR", "SOR", "STD", "LVR", "UOI", "ROV", "ABV"};
+
+#define MUT_TYPE_NUM ((int)(sizeof(MUT_TYPE_NAME) / sizeof(MUT_TYPE_NAME[0])))
+
+int __accmut__mutdb_map(const char *path, AccmutMutDB *db){
+
+	memset(db, 0, sizeof(AccmutMutDB));
+
+	int fd = open(path, O_RDONLY);
+	if(fd < 0){
+		return -1;
+	}
+
+	struct stat sb;
+	if(fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(AccmutDBHeader)){
+		close(fd);
+		return -1;
+	}
+
+	//private, the sma eval runtime rewrites the locations
+	void *map = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED){
+		return -1;
+	}
+
+	AccmutDBHeader *h = (AccmutDBHeader *)map;
+	size_t sz = sb.st_size;
+
+	if(h->magic != ACCMUT_DB_MAGIC || h->version != ACCMUT_DB_VERSION
+		|| h->rec_size != sizeof(Mutation) || h->mut_num < 0 || h->func_num < 0
+		|| h->rec_off + (long)sizeof(Mutation) * h->mut_num > (long)sz
+		|| h->loc_off + (long)sizeof(AccmutDBLoc) * h->mut_num > (long)sz
+		|| h->func_off + (long)sizeof(AccmutDBFunc) * h->func_num > (long)sz
+		|| h->str_off + h->str_size > (long)sz){
+		munmap(map, sz);
+		return -1;
+	}
+
+	db->header = h;
+	db->muts = (Mutation *)((char *)map + h->rec_off);
+	db->locs = (AccmutDBLoc *)((char *)map + h->loc_off);
+	db->funcs = (AccmutDBFunc *)((char *)map + h->func_off);
+	db->strtab = (char *)map + h->str_off;
+	db->size = sz;
+	return 0;
+}
+
+void __accmut__mutdb_unmap(AccmutMutDB *db){
+	if(db->header != NULL){
+		munmap(db->header, db->size);
+	}
+	memset(db, 0, sizeof(AccmutMutDB));
+}
+
+int __accmut__mutdb_hash_text(const char *txt_path, long *size, unsigned long *hash){
+	int fd = open(txt_path, O_RDONLY);
+	if(fd < 0){
+		return -1;
+	}
+	unsigned long h = 14695981039346656037UL;
+	long n = 0;
+	char buf[1 << 16];
+	ssize_t r;
+	while((r = read(fd, buf, sizeof(buf))) > 0){
+		ssize_t i;
+		for(i = 0; i < r; i++){
+			h ^= (unsigned char)buf[i];
+			h *= 1099511628211UL;
+		}
+		n += r;
+	}
+	close(fd);
+	if(r < 0){
+		return -1;
+	}
+	*size = n;
+	*hash = h;
+	return 0;
+}
+
+int __accmut__mutdb_stale(const AccmutMutDB *db, const char *txt_path){
+	struct stat sb;
+	if(stat(txt_path, &sb) < 0){
+		//the text has been removed for a new generation, the db is left over
+		return 1;
+	}
+	if(sb.st_size != db->header->text_size){
+		return 1;
+	}
+	//a same size edit within the same second keeps the size and the mtime
+	long size;
+	unsigned long hash;
+	if(__accmut__mutdb_hash_text(txt_path, &size, &hash) != 0){
+		return 1;
+	}
+	return size != db->header->text_size || hash != db->header->text_hash;
+}
+
+int __accmut__mutdb_parse_line(const char *line, Mutation *m, char *func, int *index){
+
+	char type[4] = {0};
+	char tail[MUTFILELINE] = {0};
+
+	if(sscanf(line, "%3s:%[^:]:%d:%s", type, func, index, tail) != 4){
+		return -1;
+	}
+
+	memset(m, 0, sizeof(Mutation));
+
+	int t;
+	for(t = 0; t < MUT_TYPE_NUM; t++){
+		if(!strcmp(type, MUT_TYPE_NAME[t])){
+			break;
+		}
+	}
+
+	m->type = (MType)t;
+
+	switch(t){
+		case AOR:
+		case LOR:
+		case ABV:{
+			//AOR,LOR: s_op:t_op, ABV: s_op:op_index
+			sscanf(tail, "%d:%d", &m->sop, &m->op_0);
+			break;
+		}
+		case ROR:
+		case UOI:
+		case ROV:{
+			//ROR: s_pre:t_pre, UOI: op_index:tp, ROV: op1:op2
+			sscanf(tail, "%d:%ld:%ld", &m->sop, &m->op_1, &m->op_2);
+			break;
+		}
+		case STD:{
+			//f_tp is 0 for void, and then there is no retval
+			sscanf(tail, "%d:%ld:%ld", &m->sop, &m->op_1, &m->op_2);
+			break;
+		}
+		case LVR:{
+			sscanf(tail, "%d:%d:%ld:%ld", &m->sop, &m->op_0, &m->op_1, &m->op_2);
+			break;
+		}
+		default:
+			return -1;
+	}
+	return 0;
+}
+
+unsigned long __accmut__mutdb_parse_key(const char *line){
+	const char *p = strstr(line, " #");
+	if(p == NULL){
+		return 0;
+	}
+	return strtoul(p + 2, NULL, 16);
+}
+
+int __accmut__mutdb_format_line(char *buf, const Mutation *m, const char *func, int index, unsigned long key){
+
+	int n = sprintf(buf, "%s:%s:%d:%d", MUT_TYPE_NAME[m->type], func, index, m->sop);
+
+	switch(m->type){
+		case AOR:
+		case LOR:
+		case ABV:
+			n += sprintf(buf + n, ":%d", m->op_0);
+			break;
+		case ROR:
+		case UOI:
+		case ROV:
+			n += sprintf(buf + n, ":%ld:%ld", m->op_1, m->op_2);
+			break;
+		case STD:
+			if(m->op_1 == 0){
+				n += sprintf(buf + n, ":0");
+			}else{
+				n += sprintf(buf + n, ":%ld:%ld", m->op_1, m->op_2);
+			}
+			break;
+		case LVR:
+			n += sprintf(buf + n, ":%d:%ld:%ld", m->op_0, m->op_1, m->op_2);
+			break;
+		default:
+			break;
+	}
+	if(key != 0){
+		n += sprintf(buf + n, " #%016lx", key);
+	}
+	buf[n++] = '\n';
+	buf[n] = '\0';
+	return n;
+}
+
+static int __accmut__write_all(int fd, const void *buf, size_t len){
+	const char *p = (const char *)buf;
+	while(len > 0){
+		ssize_t w = write(fd, p, len);
+		if(w < 0){
+			return -1;
+		}
+		p += w;
+		len -= w;
+	}
+	return 0;
+}
+
+int __accmut__mutdb_write(const char *path, Mutation *muts, const AccmutDBLoc *locs, int mut_num,
+		char **names, int name_num, const char *txt_path){
+
+	int *offs = (int *)malloc(sizeof(int) * (name_num + 1));
+	AccmutDBLoc *out_locs = (AccmutDBLoc *)malloc(sizeof(AccmutDBLoc) * (mut_num + 1));
+	AccmutDBFunc *funcs = (AccmutDBFunc *)malloc(sizeof(AccmutDBFunc) * (mut_num + 1));
+	if(offs == NULL || out_locs == NULL || funcs == NULL){
+		free(offs);
+		free(out_locs);
+		free(funcs);
+		return -1;
+	}
+
+	long str_size = 0;
+	int i;
+	for(i = 0; i < name_num; i++){
+		offs[i] = str_size;
+		str_size += strlen(names[i]) + 1;
+	}
+
+	//the same locations as the old text loader: count from 2, negative in a loop
+	int func_num = 0;
+	int cur_loc = 1;
+	int pre_name = -1;
+	int pre_idx = -1;
+	for(i = 0; i < mut_num; i++){
+		int name = locs[i].name_off;
+		int idx = locs[i].index < 0 ? -locs[i].index : locs[i].index;
+		if(name != pre_name || idx != pre_idx){
+			cur_loc++;
+		}
+		muts[i].location = locs[i].index < 0 ? -cur_loc : cur_loc;
+
+		if(name != pre_name){
+			funcs[func_num].name_off = offs[name];
+			funcs[func_num].first = i + 1;
+			funcs[func_num].count = 0;
+			funcs[func_num].reserved = 0;
+			func_num++;
+		}
+		funcs[func_num - 1].count++;
+
+		out_locs[i].name_off = offs[name];
+		out_locs[i].index = locs[i].index;
+		out_locs[i].key = locs[i].key;
+
+		pre_name = name;
+		pre_idx = idx;
+	}
+
+	AccmutDBHeader h;
+	memset(&h, 0, sizeof(h));
+	h.magic = ACCMUT_DB_MAGIC;
+	h.version = ACCMUT_DB_VERSION;
+	h.mut_num = mut_num;
+	h.func_num = func_num;
+	h.rec_size = sizeof(Mutation);
+	h.rec_off = sizeof(AccmutDBHeader);
+	h.loc_off = h.rec_off + sizeof(Mutation) * mut_num;
+	h.func_off = h.loc_off + sizeof(AccmutDBLoc) * mut_num;
+	h.str_off = h.func_off + sizeof(AccmutDBFunc) * func_num;
+	h.str_size = str_size;
+
+	if(txt_path != NULL){
+		__accmut__mutdb_hash_text(txt_path, &h.text_size, &h.text_hash);
+	}
+
+	char tmp[256];
+	sprintf(tmp, "%s.%d", path, getpid());
+
+	int ret = -1;
+	int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd >= 0){
+		ret = __accmut__write_all(fd, &h, sizeof(h));
+		if(ret == 0)
+			ret = __accmut__write_all(fd, muts, sizeof(Mutation) * mut_num);
+		if(ret == 0)
+			ret = __accmut__write_all(fd, out_locs, sizeof(AccmutDBLoc) * mut_num);
+		if(ret == 0)
+			ret = __accmut__write_all(fd, funcs, sizeof(AccmutDBFunc) * func_num);
+		for(i = 0; ret == 0 && i < name_num; i++){
+			ret = __accmut__write_all(fd, names[i], strlen(names[i]) + 1);
+		}
+		close(fd);
+		//readers never see a half written db
+		if(ret == 0){
+			ret = rename(tmp, path);
+		}
+		if(ret != 0){
+			unlink(tmp);
+		}
+	}
+
+	free(offs);
+	free(out_locs);
+	free(funcs);
+	return ret;
+}
@@ -0,0 +1,116 @@
+#ifndef ACCMUT_MUTDB_H
+#define ACCMUT_MUTDB_H
+
+#include "accmut_config.h"
+
+/*
+* The binary mutation database $HOME/tmp/accmut/mutations.db.
+* It holds the same mutants as mutations.txt, but it is mapped, not parsed:
+*
+*	AccmutDBHeader
+*	Mutation		records[mut_num]	mutant i is records[i - 1], in the layout
+*										of the runtime, ALLMUTS points into the map
+*	AccmutDBLoc		locs[mut_num]		function, instruction index and key of a mutant
+*	AccmutDBFunc	funcs[func_num]		runs of consecutive mutants of a function
+*	char			strtab[str_size]	function names, '\0' terminated
+*
+* MutationGen only appends to mutations.txt, the db is built from the whole
+* text by the first instrumenter that finds it missing or stale. The compiler
+* side of this layout is include/llvm/Transforms/AccMut/MutationDB.h, keep
+* them the same.
+* utils/mutdb converts between the text and the binary format.
+*/
+
+#define ACCMUT_DB_MAGIC 0x42444341	/* "ACDB" */
+#define ACCMUT_DB_VERSION 3
+
+typedef struct AccmutDBHeader{
+	unsigned magic;
+	unsigned version;
+	int mut_num;
+	int func_num;
+	int rec_size;		/* sizeof(Mutation) */
+	int reserved;
+	long text_size;		/* mutations.txt the db was built from, if the text */
+	unsigned long text_hash;	/* changes later (hand sampling) the db is stale */
+	long rec_off;
+	long loc_off;
+	long func_off;
+	long str_off;
+	long str_size;
+}AccmutDBHeader;
+
+typedef struct AccmutDBLoc{
+	int name_off;		/* the function, offset in strtab */
+	int index;			/* the instruction, negative in a loop */
+	unsigned long key;	/* the stable key, 0 if none */
+}AccmutDBLoc;
+
+typedef struct AccmutDBFunc{
+	int name_off;
+	int first;			/* id of the first mutant */
+	int count;
+	int reserved;
+}AccmutDBFunc;
+
+typedef struct AccmutMutDB{
+	AccmutDBHeader *header;
+	Mutation *muts;
+	AccmutDBLoc *locs;
+	AccmutDBFunc *funcs;
+	char *strtab;
+	size_t size;
+}AccmutMutDB;
+
+/*
+* The instrumenter also embeds the records of the mutants of every module
+* into the section accmut_muts (see MutUtil::embedMutations), the linker
+* puts the tables of all the modules together. The runtime then needs no
+* mutations.txt or mutations.db at all.
+*/
+typedef struct AccmutEmbeddedMut{
+	int id;
+	int mut_num;		/* the number of all the mutants, not only these */
+	Mutation mut;
+	unsigned long key;
+}AccmutEmbeddedMut;
+
+/* map the db copy on write, 0 on success, -1 if it is missing or broken */
+int __accmut__mutdb_map(const char *path, AccmutMutDB *db);
+
+void __accmut__mutdb_unmap(AccmutMutDB *db);
+
+/* whether the text has changed or gone since the db was written */
+int __accmut__mutdb_stale(const AccmutMutDB *db, const char *txt_path);
+
+/* the size and the FNV-1a hash of the text, -1 if it can not be read */
+int __accmut__mutdb_hash_text(const char *txt_path, long *size, unsigned long *hash);
+
+/*
+* Parse one line of mutations.txt, func gets the function name (MUTFILELINE
+* bytes at most). Returns -1 for an unknown mutation type.
+*/
+int __accmut__mutdb_parse_line(const char *line, Mutation *m, char *func, int *index);
+
+/*
+* The stable key of a mutant is a 64 bit hash of what it mutates: the
+* function, its basic block, its instruction and the operator with its
+* parameters (see include/llvm/Transforms/AccMut/MutationKey.h). It is the
+* same across the builds, the id (the line in mutations.txt) is not. The
+* generator writes it at the end of the line as " #KEY" in hex.
+* Returns 0 if the line has no key.
+*/
+unsigned long __accmut__mutdb_parse_key(const char *line);
+
+/* the line of mutations.txt for a mutant, '\n' included, key 0 for none */
+int __accmut__mutdb_format_line(char *buf, const Mutation *m, const char *func, int index, unsigned long key);
+
+/*
+* Write a db of mut_num mutants, locs[i].name_off is an index in names.
+* The locations of muts are recomputed. txt_path is the text file the db
+* is in sync with, or NULL. Returns 0 on success.
+*/
+int __accmut__mutdb_write(const char *path, Mutation *muts, const AccmutDBLoc *locs, int mut_num,
+		char **names, int name_num, const char *txt_path);
+
+#endif
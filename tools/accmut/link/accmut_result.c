@@ -0,0 +1,304 @@
+#include "accmut_config.h"
+#include "accmut_exitcode.h"
+#include "accmut_result.h"
+#include "accmut_bitmap.h"
+#include "accmut_sched.h"
+
+#define __real_fprintf fprintf
+
+static AccmutResultRegion *RESULTS = NULL;
+
+static unsigned long *KILLED = NULL;
+
+//the files digest of every survivor, shared, compared by the original at exit
+static unsigned long *FILES = NULL;
+
+static void __accmut__killed_init(){
+
+	char *env = getenv(ACCMUT_KILL_ONCE_ENV);
+	if(env == NULL || atoi(env) == 0){
+		return;
+	}
+
+	char path[256];
+	sprintf(path, "%s%s%s/killed", getenv("HOME"), "/tmp/accmut/results/", PROJECT);
+
+	KILLED = __accmut__bitmap_map(path, MUT_NUM + 1, 1);
+	if(KILLED == NULL){
+		ERRMSG("KILLED BITMAP OPEN ERR");
+		exit(FOPEN_ERR);
+	}
+}
+
+int __accmut__is_killed(int mut_id){
+	return KILLED != NULL && ACCMUT_BIT_TEST(KILLED, mut_id);
+}
+
+static unsigned long *COVER_RECORD = NULL;	/* written by a coverage run */
+static unsigned long *COVERED = NULL;		/* left by the last coverage run */
+
+static void __accmut__coverage_init(){
+
+	char path[256];
+	sprintf(path, "%s%s%s/t%d", getenv("HOME"), "/tmp/accmut/coverage/", PROJECT, TEST_ID);
+
+	char *env = getenv(ACCMUT_COVERAGE_ENV);
+	if(env == NULL || atoi(env) == 0){
+		COVERED = __accmut__bitmap_map(path, MUT_NUM + 1, 0);
+		return;
+	}
+
+	//drop the locations of the last run
+	unlink(path);
+	COVER_RECORD = __accmut__bitmap_map(path, MUT_NUM + 1, 1);
+	if(COVER_RECORD == NULL){
+		ERRMSG("COVERAGE BITMAP OPEN ERR");
+		exit(FOPEN_ERR);
+	}
+}
+
+int __accmut__is_covered(int mut_id){
+	if(mut_id == 0){
+		return 1;
+	}
+	if(COVER_RECORD != NULL){
+		return 0;
+	}
+	return COVERED == NULL || ACCMUT_BIT_TEST(COVERED, mut_id);
+}
+
+void __accmut__cover(int from, int to){
+	//all the mutants of a location are set together
+	if(COVER_RECORD == NULL || ACCMUT_BIT_TEST(COVER_RECORD, to)){
+		return;
+	}
+	int i;
+	for(i = from; i <= to; i++){
+		ACCMUT_BIT_SET(COVER_RECORD, i);
+	}
+}
+
+#define GROUP_MAX 64
+
+static int GROUP_FROM[GROUP_MAX];
+static int GROUP_TO[GROUP_MAX];
+static int GROUP_NUM = -1;	/* all the mutants */
+
+static void __accmut__group_init(){
+
+	char *env = getenv(ACCMUT_MUTANTS_ENV);
+	if(env == NULL){
+		return;
+	}
+	GROUP_NUM = 0;
+	int n;
+	while(GROUP_NUM < GROUP_MAX && sscanf(env, "%d-%d%n", &GROUP_FROM[GROUP_NUM], &GROUP_TO[GROUP_NUM], &n) == 2
+			&& GROUP_FROM[GROUP_NUM] <= GROUP_TO[GROUP_NUM]){
+		GROUP_NUM++;
+		env += n;
+		if(*env != ','){
+			break;
+		}
+		env++;
+	}
+	if(GROUP_NUM == 0 || *env != '\0'){
+		ERRMSG("ACCMUT_MUTANTS IS NOT FROM-TO[,FROM-TO...] ");
+		exit(ENV_ERR);
+	}
+}
+
+int __accmut__in_group(int mut_id){
+	if(mut_id == 0 || GROUP_NUM < 0){
+		return 1;
+	}
+	int i;
+	for(i = 0; i < GROUP_NUM; i++){
+		if(mut_id >= GROUP_FROM[i] && mut_id <= GROUP_TO[i]){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void __accmut__result_write(int outcome, int exitcd){
+
+	if(RESULTS == NULL){
+		return;
+	}
+
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	long cpu = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000L
+				+ ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+
+	pid_t pid = getpid();
+
+	unsigned long files = outcome == OUT_SURVIVED ? __accmut__files_digest() : 0;
+
+	const int *muts;
+	int num = __accmut__represented_muts(&muts);
+	int i;
+	for(i = 0; i < num; i++){
+		int m = muts[i];
+		if(m < 0 || m > RESULTS->mut_num){
+			continue;
+		}
+		AccmutResult *r = &RESULTS->records[m];
+		//the mutant has been split off to another process
+		if(r->pid != pid){
+			continue;
+		}
+		r->exit_code = exitcd;
+		r->cpu_usec = cpu;
+		r->max_rss = ru.ru_maxrss;
+		r->exec_count = __accmut__exec_count;
+		if(FILES != NULL && outcome == OUT_SURVIVED){
+			FILES[m] = files;
+		}
+		__atomic_store_n(&r->outcome, outcome, __ATOMIC_RELEASE);
+		__sync_fetch_and_add(&RESULTS->finished, 1);
+
+		if(KILLED != NULL && m > 0 && outcome != OUT_SURVIVED){
+			ACCMUT_BIT_SET_ATOMIC(KILLED, m);
+		}
+	}
+}
+
+/*
+* The original is the oracle of the files: once all its mutants are done,
+* the survivors whose files differ from its own are killed.
+*/
+static void __accmut__result_check_files(){
+
+	__accmut__sched_wait_all();
+
+	unsigned long files = __accmut__files_digest();
+	int i;
+	for(i = 1; i <= RESULTS->mut_num; i++){
+		AccmutResult *r = &RESULTS->records[i];
+		if(r->test_id != TEST_ID || r->outcome != OUT_SURVIVED || FILES[i] == files){
+			continue;
+		}
+		r->outcome = OUT_KILLED;
+		if(KILLED != NULL){
+			ACCMUT_BIT_SET_ATOMIC(KILLED, i);
+		}
+	}
+}
+
+static void __accmut__result_on_exit(int status, void *arg){
+	int outcome = OUT_SURVIVED;
+	if(__accmut__checkoutput() != 0){
+		outcome = OUT_KILLED;
+	}
+	__accmut__result_write(outcome, status);
+
+	if(MUTATION_ID == 0 && FILES != NULL){
+		__accmut__result_check_files();
+	}
+}
+
+void __accmut__result_init(){
+
+	__accmut__killed_init();
+
+	__accmut__group_init();
+
+	__accmut__coverage_init();
+
+	//the results of the test stay those of its last real run
+	if(COVER_RECORD != NULL){
+		return;
+	}
+
+	char path[256];
+	char *file = getenv(ACCMUT_RESULT_FILE_ENV);
+	if(file != NULL){
+		snprintf(path, sizeof(path), "%s", file);
+	}else{
+		sprintf(path, "%s%s%s/t%d", getenv("HOME"), "/tmp/accmut/results/", PROJECT, TEST_ID);
+	}
+
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	if(fd < 0){
+		#if 0
+		__real_fprintf(stderr, "WARNING : RESULT FILE CAN NOT BE OPENED : %s\n", path);
+		#endif
+		return;
+	}
+
+	size_t sz = ACCMUT_RES_SIZE(MUT_NUM);
+
+	//drop the records of the last run
+	if(ftruncate(fd, 0) < 0 || ftruncate(fd, sz) < 0){
+		ERRMSG("ftruncate ERR ");
+		close(fd);
+		return;
+	}
+
+	void *region = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(region == MAP_FAILED){
+		ERRMSG("mmap ERR ");
+		return;
+	}
+
+	RESULTS = (AccmutResultRegion *)region;
+
+	FILES = (unsigned long *)mmap(NULL, sizeof(unsigned long) * (MUT_NUM + 1),
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(FILES == MAP_FAILED){
+		FILES = NULL;
+	}
+	RESULTS->magic = ACCMUT_RES_MAGIC;
+	RESULTS->version = ACCMUT_RES_VERSION;
+	RESULTS->test_id = TEST_ID;
+	RESULTS->mut_num = MUT_NUM;
+
+	int i;
+	for(i = 1; i <= MUT_NUM; i++){
+		RESULTS->records[i].key = __accmut__mut_key(i);
+		if(__accmut__is_killed(i)){
+			RESULTS->records[i].test_id = TEST_ID;
+			RESULTS->records[i].outcome = OUT_SKIPPED;
+		}else if(__accmut__in_group(i) && !__accmut__is_covered(i)){
+			RESULTS->records[i].test_id = TEST_ID;
+			RESULTS->records[i].outcome = OUT_NOT_COVERED;
+		}
+	}
+
+	//record 0 belongs to the main process
+	__accmut__result_start();
+
+	if(on_exit(__accmut__result_on_exit, NULL) != 0){
+		ERRMSG("on_exit ERR ");
+		exit(ENV_ERR);
+	}
+}
+
+void __accmut__result_start(){
+
+	if(RESULTS == NULL){
+		return;
+	}
+
+	pid_t pid = getpid();
+
+	const int *muts;
+	int num = __accmut__represented_muts(&muts);
+	int i;
+	for(i = 0; i < num; i++){
+		int m = muts[i];
+		if(m < 0 || m > RESULTS->mut_num){
+			continue;
+		}
+		AccmutResult *r = &RESULTS->records[m];
+		r->test_id = TEST_ID;
+		r->pid = pid;
+		__atomic_store_n(&r->outcome, OUT_RUNNING, __ATOMIC_RELEASE);
+	}
+}
+
+void __accmut__result_abort(int outcome, int exitcd){
+	__accmut__result_write(outcome, exitcd);
+}
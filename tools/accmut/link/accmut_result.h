@@ -0,0 +1,111 @@
+#ifndef ACCMUT_RESULT_H
+#define ACCMUT_RESULT_H
+
+/*
+* The kill results of one test.
+* The main process maps $HOME/tmp/accmut/results/<PROJECT>/t<TEST_ID> shared
+* before the first fork, with one record per mutant (record 0 is the
+* original program). Every forked process writes the records of the
+* mutants it stands for, so no one has to scrape stderr anymore.
+* utils/killmatrix turns the regions of all the tests into a matrix.
+*/
+
+#define ACCMUT_RES_MAGIC 0x52434341	/* "ACCR" */
+#define ACCMUT_RES_VERSION 3
+
+typedef enum ACCMUT_OUTCOME{
+	OUT_NOT_RUN = 0,	/* never forked, same as the original on this test */
+	OUT_RUNNING,		/* forked, but gone without a word (e.g. SIGKILL) */
+	OUT_SURVIVED,		/* exited, same output as the original */
+	OUT_KILLED,			/* exited, different output */
+	OUT_TIMEOUT,
+	OUT_CRASH,
+	OUT_EXIT_DIFF,		/* survived, but exit code differs from the original,
+						   only set when the matrix is built */
+	OUT_SKIPPED,		/* killed by an earlier test, not run (kill once) */
+	OUT_NOT_COVERED		/* its location is never reached by the test, not run */
+}AccmutOutcome;
+
+typedef struct AccmutResult{
+	int test_id;
+	int outcome;
+	int exit_code;
+	int pid;
+	long cpu_usec;	/* user + sys */
+	long max_rss;	/* KB */
+	long exec_count;	/* back edges and calls, with ACCMUT_EXEC_BUDGET_INSTRUMENT */
+	unsigned long key;	/* the stable key of the mutant, see accmut_mutdb.h */
+}AccmutResult;
+
+typedef struct AccmutResultRegion{
+	unsigned magic;
+	unsigned version;
+	int test_id;
+	int mut_num;
+	int finished;	/* records written so far, updated atomically */
+	int reserved[3];
+	AccmutResult records[];
+}AccmutResultRegion;
+
+#define ACCMUT_RES_SIZE(mut_num) \
+	(sizeof(AccmutResultRegion) + sizeof(AccmutResult) * ((mut_num) + 1))
+
+/*
+* Kill once campaign: with ACCMUT_KILL_ONCE=1 the runtime keeps a bitmap of
+* the killed mutants in $HOME/tmp/accmut/results/<PROJECT>/killed, shared by
+* all the tests, and never forks a mutant again once a test has killed it.
+*/
+#define ACCMUT_KILL_ONCE_ENV "ACCMUT_KILL_ONCE"
+
+/*
+* Mutant groups: with ACCMUT_MUTANTS=FROM-TO the runtime only runs the
+* mutants FROM..TO, the records of the others stay OUT_NOT_RUN. Several
+* ranges are separated by commas (FROM-TO,FROM-TO,...).
+* ACCMUT_RESULT_FILE overrides the path of the region, so that the groups
+* of one test can run at the same time (see utils/campaign).
+*/
+#define ACCMUT_MUTANTS_ENV "ACCMUT_MUTANTS"
+#define ACCMUT_RESULT_FILE_ENV "ACCMUT_RESULT_FILE"
+
+/*
+* The drivers (utils/campaign, utils/calibrate, the fork server) pass the id
+* of the test in ACCMUT_TEST_ID. When it is set it is the TEST_ID of the
+* run, whatever the subject has taken from its arguments.
+*/
+#define ACCMUT_TEST_ID_ENV "ACCMUT_TEST_ID"
+
+/*
+* Coverage gating: with ACCMUT_COVERAGE=1 the runtime forks no mutant and
+* writes no region, it only sets the bits of the mutants of every location
+* the original reaches in $HOME/tmp/accmut/coverage/<PROJECT>/t<TEST_ID>.
+* The locations already call the runtime with their mutants FROM..TO, so
+* no other instrumentation is needed. A later run of the test finding that
+* bitmap does not run the mutants whose bits are clear: until it reaches
+* the location a mutant is the original, so it would survive anyway.
+* Their records are marked OUT_NOT_COVERED. Remove the bitmaps after
+* generating the mutants again.
+*/
+#define ACCMUT_COVERAGE_ENV "ACCMUT_COVERAGE"
+
+/* map the region of TEST_ID, after __accmut__load_all_muts() */
+void __accmut__result_init();
+
+/* whether an earlier test of a kill once campaign has killed the mutant */
+int __accmut__is_killed(int mut_id);
+
+/* whether the test may reach the mutant, 0 for all the mutants in a coverage run */
+int __accmut__is_covered(int mut_id);
+
+/* the location of the mutants from..to is reached, by every runtime entry */
+void __accmut__cover(int from, int to);
+
+/* whether the mutant is in the group of ACCMUT_MUTANTS, after __accmut__result_init() */
+int __accmut__in_group(int mut_id);
+
+/* a forked process claims the records of the mutants it stands for */
+void __accmut__result_start();
+
+/* the process is about to _exit(exitcd), async signal safe */
+void __accmut__result_abort(int outcome, int exitcd);
+
+#endif
@@ -0,0 +1,175 @@
+#include <errno.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+
+#include "accmut_config.h"
+#include "accmut_exitcode.h"
+#include "accmut_sched.h"
+
+#define __real_fprintf fprintf
+
+/*
+* The job slots are tokens in a pipe, like the jobserver of make.
+* A father takes a token before fork, the child owns it and gives it back
+* when it exits. If there is no token, the father waits for the child and
+* lends its own slot, so the number of running processes never exceeds
+* ACCMUT_JOBS and no one can dead lock on a token. A child killed by a
+* signal (e.g. SIGKILL) can not give its token back, its father does when
+* it reaps it. The orphans of a dead father are reaped by the main process
+* at the end only, their tokens are lost until then.
+*/
+
+static int JOBS = 1;
+static int SLOT_FD[2] = {-1, -1};
+static pid_t ROOT_PID = 0;
+
+/* whether this process runs on a token of its own */
+static int HOLD_SLOT = 0;
+
+/* the children running on their own tokens */
+static pid_t *CHILDREN = NULL;
+static int CHILD_NUM = 0;
+static int CHILD_CAP = 0;
+
+
+void __accmut__sched_init(){
+
+	char *env = getenv(ACCMUT_JOBS_ENV);
+
+	if(env != NULL){
+		JOBS = atoi(env);
+		if(JOBS <= 0){
+			JOBS = sysconf(_SC_NPROCESSORS_ONLN);
+		}
+	}
+
+	if(JOBS <= 1){
+		return;
+	}
+
+	if(pipe(SLOT_FD) < 0){
+		ERRMSG("pipe ERR ");
+		exit(ENV_ERR);
+	}
+
+	fcntl(SLOT_FD[0], F_SETFL, O_NONBLOCK);
+	fcntl(SLOT_FD[0], F_SETFD, FD_CLOEXEC);
+	fcntl(SLOT_FD[1], F_SETFD, FD_CLOEXEC);
+
+	//the main process holds one slot itself
+	int i;
+	char token = '+';
+	for(i = 1; i < JOBS; i++){
+		write(SLOT_FD[1], &token, 1);
+	}
+
+	//the orphans of the processes killed by timeout come back to us
+	prctl(PR_SET_CHILD_SUBREAPER, 1);
+
+	ROOT_PID = getpid();
+
+	atexit(__accmut__sched_wait_all);
+}
+
+static void __accmut__sched_add_child(pid_t pid){
+	if(CHILD_NUM == CHILD_CAP){
+		CHILD_CAP = CHILD_CAP == 0 ? 16 : CHILD_CAP * 2;
+		CHILDREN = (pid_t *)realloc(CHILDREN, sizeof(pid_t) * CHILD_CAP);
+		if(CHILDREN == NULL){
+			ERRMSG("realloc ERR ");
+			exit(MELLOC_ERR);
+		}
+	}
+	CHILDREN[CHILD_NUM++] = pid;
+}
+
+void __accmut__sched_reap(){
+	int i = 0;
+	while(i < CHILD_NUM){
+		int status;
+		pid_t r = waitpid(CHILDREN[i], &status, WNOHANG);
+		if(r != 0){
+			//killed by a signal before it could give its token back
+			if(r > 0 && WIFSIGNALED(status)){
+				char token = '+';
+				write(SLOT_FD[1], &token, 1);
+			}
+			CHILDREN[i] = CHILDREN[--CHILD_NUM];
+		}else{
+			i++;
+		}
+	}
+}
+
+pid_t __accmut__sched_fork(){
+
+	int got = 0;
+
+	if(SLOT_FD[0] >= 0){
+		__accmut__sched_reap();
+		char token;
+		got = (read(SLOT_FD[0], &token, 1) == 1);
+	}
+
+	pid_t pid = fork();
+
+	if(pid < 0){
+		if(got){
+			char token = '+';
+			write(SLOT_FD[1], &token, 1);
+		}
+		return pid;
+	}
+
+	if(pid == 0){
+		HOLD_SLOT = got;
+		CHILD_NUM = 0;
+		return 0;
+	}
+
+	if(got){
+		__accmut__sched_add_child(pid);
+		return pid;
+	}
+
+	//no free slot, the child runs on ours
+	while(waitpid(pid, NULL, 0) < 0){
+		if(errno != EINTR){
+			ERRMSG("waitpid ERR ");
+			exit(ENV_ERR);
+		}
+	}
+	return pid;
+}
+
+void __accmut__sched_release(){
+	if(HOLD_SLOT){
+		HOLD_SLOT = 0;
+		char token = '+';
+		write(SLOT_FD[1], &token, 1);
+	}
+}
+
+void __accmut__sched_wait_all(){
+
+	__accmut__sched_release();
+
+	if(getpid() != ROOT_PID){
+		return;
+	}
+
+	//the main timers must not fire while we are waiting
+	struct itimerval zero;
+	memset(&zero, 0, sizeof(zero));
+	setitimer(ITIMER_REAL, &zero, NULL);
+	setitimer(ITIMER_PROF, &zero, NULL);
+
+	while(1){
+		if(waitpid(-1, NULL, 0) < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			break;
+		}
+	}
+}
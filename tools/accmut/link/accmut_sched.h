@@ -0,0 +1,27 @@
+#ifndef ACCMUT_SCHED_H
+#define ACCMUT_SCHED_H
+
+#include <sys/types.h>
+
+/*
+* Job slots for the forked mutant processes.
+* ACCMUT_JOBS=N lets at most N processes of one test run at the same time,
+* ACCMUT_JOBS=0 means one per online cpu. Unset keeps the serial behaviour.
+*/
+#define ACCMUT_JOBS_ENV "ACCMUT_JOBS"
+
+void __accmut__sched_init();
+
+/* same as fork(), but the father only blocks when no job slot is free */
+pid_t __accmut__sched_fork();
+
+/* give the slot of the current process back, async signal safe */
+void __accmut__sched_release();
+
+/* reap all the finished children without blocking */
+void __accmut__sched_reap();
+
+/* exit handler, waits for all the forked processes */
+void __accmut__sched_wait_all();
+
+#endif
@@ -8,8 +8,11 @@
 #include "accmut_process.h"
 #include "accmut_arith_common.h"
 #include "accmut_config.h"
-/*#include "accmut_io.h"*/
+#include "accmut_io.h"
 #include "accmut_exitcode.h"
+#include "accmut_sched.h"
+#include "accmut_result.h"
+#include "accmut_bitmap.h"
 
 extern struct itimerval ACCMUT_PROF_TICK;
 extern struct itimerval ACCMUT_REAL_TICK;
@@ -20,9 +23,8 @@ extern struct timeval tv_begin, tv_end;
 extern int TEST_ID;
 extern const char PROJECT[];
 
-extern Mutation* ALLMUTS[MAXMUTNUM + 1];
 extern int MUT_NUM;
-extern int *MUTS_ON;
+extern unsigned long *MUTS_ON;
 
 
 //#define fprintf __real_fprintf
@@ -32,6 +34,8 @@ extern int *MUTS_ON;
 
 void __accmut__init(){
 	
+	__accmut__test_id_init();
+
     gettimeofday(&tv_begin, NULL);
     
     atexit(__accmut__exit_time);
@@ -39,10 +43,8 @@ void __accmut__init(){
 	__accmut__sepcific_timer();
 
 	__accmut__set_sig_handlers();
-	
-#if 0
-	__accmut__init_stdstream();
-#endif
+
+	__accmut__sched_init();
 
 	if(TEST_ID < 0){
 		ERRMSG("TEST_ID NOT INIT");
@@ -51,16 +53,21 @@ void __accmut__init(){
 
 	__accmut__load_all_muts();
 
+	__accmut__result_init();
 
-	MUTS_ON = (int *) malloc( (sizeof(int)) * (MUT_NUM + 1) );
+	//stdin and the oracle of the test, before the first fork
+	__accmut__init_stdstream();
+
+	MUTS_ON = (unsigned long *) calloc(ACCMUT_BITMAP_WORDS(MUT_NUM + 1), sizeof(unsigned long));
+	if(MUTS_ON == NULL){
+		ERRMSG("calloc ERR ");
+		exit(MELLOC_ERR);
+	}
 	
 	int i;
 
 
 #if ACCMUT_STATIC_ANALYSIS_FORK_CALL
-	for(i = 1; i < MUT_NUM + 1; i++){
-		*(MUTS_ON + i) = 0;
-	}
 
 	char path[128];
 	sprintf(path, "%s%s%s/t%d", getenv("HOME"), "/tmp/accmut/input/", PROJECT, TEST_ID);
@@ -73,15 +80,15 @@ void __accmut__init(){
 	}
 	int curmut, on_id;
 	while(fscanf(fp,"%d:%d", &curmut, &on_id) != EOF){
-			if(on_id == -1 || curmut == on_id){
+			if((on_id == -1 || curmut == on_id) && curmut > 0 && curmut <= MUT_NUM){
 				//fprintf(stderr,"CURMUT: %d, ON_ID: %d\n", curmut, on_id);
-				*(MUTS_ON + curmut) = 1;
+				ACCMUT_BIT_SET(MUTS_ON, curmut);
 			}				                	            
     }
     fclose(fp);
 #elif ACCMUT_MUTATION_SCHEMATA
 	for(i = 0; i < MUT_NUM + 1; i++){
-		*(MUTS_ON + i) = 1;
+		ACCMUT_BIT_SET(MUTS_ON, i);
 	}
 #endif
 
@@ -89,10 +96,10 @@ void __accmut__init(){
 
    	for(i = 1; i < MUT_NUM + 1; i++){
 
-		if(MUTATION_ID == 0 && (MUTS_ON[i] == 1) ){
+		if(MUTATION_ID == 0 && ACCMUT_BIT_TEST(MUTS_ON, i) && __accmut__in_group(i) && !__accmut__is_killed(i) && __accmut__is_covered(i) ){
 		
 			// fprintf(stderr, "FORK MUT: %d\n", i);
-			pid_t pid = fork();
+			pid_t pid = __accmut__sched_fork();
 			
 			if(pid < 0){
 				ERRMSG("fork ERR ");
@@ -111,14 +118,12 @@ void __accmut__init(){
 	                perror("mprotect ERR : PROT_READ");
 	                exit(errno);
 	            }
+
+				__accmut__result_start();
 				
 				//fprintf(stderr, "%d %d\n", TEST_ID, MUTATION_ID);
 				
-				int r1 = setitimer(ITIMER_REAL, &ACCMUT_REAL_TICK, NULL); 
-				
-				int r2 = setitimer(ITIMER_PROF, &ACCMUT_PROF_TICK, NULL); 
-
-				if(r1 < 0 || r2 < 0){
+				if(__accmut__arm_timeout() < 0){
 					ERRMSG("setitimer ERR ");
 					exit(ENV_ERR);
 				}
@@ -126,7 +131,6 @@ void __accmut__init(){
 				break;
 			}else{//father process	
 				TOTALFORK++;
-				int pr = waitpid(pid, NULL, 0);
 
 				struct itimerval MAIN_REAL_TICK, MAIN_PROF_TICK;
             	MAIN_REAL_TICK.it_value.tv_sec = 0;  // sec
@@ -135,11 +139,6 @@ void __accmut__init(){
             	MAIN_PROF_TICK.it_value.tv_usec = 100000; // u sec.
             	int r1 = setitimer(ITIMER_REAL, &MAIN_REAL_TICK, NULL); 
             	int r2 = setitimer(ITIMER_PROF, &MAIN_PROF_TICK, NULL); 
-
-				if(pr < 0){
-					ERRMSG("waitpid ERR ");
-					exit(ENV_ERR);
-				}
 			}
 		}
 
@@ -162,6 +161,8 @@ void __accmut__init(){
 */
 int __accmut__prepare_call(int from, int to, int opnum, ...){
 
+	__accmut__cover(from, to);
+
 	if(MUTATION_ID == 0 || MUTATION_ID < from || MUTATION_ID > to){
 		return 0;
 	}
@@ -546,6 +547,8 @@ void __accmut__stdcall_void(){/*do nothing*/}
 
 int __accmut__process_i32_arith(int from, int to, int left, int right){
 
+	__accmut__cover(from, to);
+
 	int ori = __accmut__cal_i32_arith(ALLMUTS[to]->sop , left, right);
 	
 	if(MUTATION_ID == 0 || MUTATION_ID < from || MUTATION_ID > to){
@@ -629,6 +632,8 @@ int __accmut__process_i32_arith(int from, int to, int left, int right){
 
 long __accmut__process_i64_arith(int from, int to, long left, long right){
 
+	__accmut__cover(from, to);
+
 	long ori = __accmut__cal_i64_arith(ALLMUTS[to]->sop , left, right);
 	
 	if(MUTATION_ID == 0 || MUTATION_ID < from || MUTATION_ID > to){
@@ -712,6 +717,8 @@ long __accmut__process_i64_arith(int from, int to, long left, long right){
 
 int __accmut__process_i32_cmp(int from, int to, int left, int right){
 
+	__accmut__cover(from, to);
+
 	int s_pre = ALLMUTS[to]->op_1;
 
 	if(MUTATION_ID == 0 || MUTATION_ID < from || MUTATION_ID > to){
@@ -792,6 +799,8 @@ int __accmut__process_i32_cmp(int from, int to, int left, int right){
 }//end __accmut__process_i32_cmp
 
 int __accmut__process_i64_cmp(int from, int to, long left, long right){
+
+	__accmut__cover(from, to);
 	
 	int s_pre = ALLMUTS[to]->op_1;
 
@@ -874,6 +883,8 @@ int __accmut__process_i64_cmp(int from, int to, long left, long right){
 
 
 int __accmut__prepare_st_i32(int from, int to, int tobestore, int *addr){
+
+	__accmut__cover(from, to);
 	
 	if(MUTATION_ID == 0 || MUTATION_ID < from || MUTATION_ID > to){
 		*addr = tobestore;
@@ -918,6 +929,8 @@ int __accmut__prepare_st_i32(int from, int to, int tobestore, int *addr){
 }
 
 int __accmut__prepare_st_i64(int from, int to, long tobestore, long* addr){
+
+	__accmut__cover(from, to);
 	
 	if(MUTATION_ID == 0 || MUTATION_ID < from || MUTATION_ID > to){
 		*addr = tobestore;
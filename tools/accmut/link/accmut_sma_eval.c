@@ -8,24 +8,27 @@
 #include "accmut_config.h"
 #include "accmut_io.h"
 #include "accmut_exitcode.h"
+#include "accmut_bitmap.h"
 
 #define fprintf __real_fprintf
 
-#define MAXINDEXNUM MAXMUTNUM
-
 #define MAX_COV_TIME 1
 
 extern struct timeval tv_begin, tv_end;
 
-static int COVERED_LOCATIONS[MAXINDEXNUM];
+/* sized from MUT_NUM and the number of locations in __accmut__init() */
+
+static int LOC_NUM;
+
+static unsigned long *COVERED_LOCATIONS;	/* bitset of the locations */
 
-static long ORIRES[MAXINDEXNUM];
+static long *ORIRES;	/* by location */
 
-static long MUTRES[MAXMUTNUM];
+static long *MUTRES;
 
-static int UNSUPORTED[MAXMUTNUM];
+static unsigned long *UNSUPORTED;	/* bitset of the mutants */
 
-static int PARENT[MAXMUTNUM];
+static int *PARENT;
 
 
 /**************************** ARITH ***************************************/
@@ -36,16 +39,16 @@ int __accmut__process_i32_arith(int from, int to, int left, int right){
 
     //printf("ARI FROM: %d  TO: %d  SPRE : %d  ORI: %d\n", from, to, ALLMUTS[to]->sop, ori);
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return ori;
     }
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = ori;
 
     int i;
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -131,16 +134,16 @@ long __accmut__process_i64_arith(int from, int to, long left, long right){
     int ori = __accmut__cal_i64_arith(ALLMUTS[to]->sop , left, right);
     
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return ori;
     }
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = ori;
 
     int i;
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -231,16 +234,16 @@ int __accmut__process_i32_cmp(int from, int to, int left, int right){
     //printf("CMP FROM: %d  TO: %d  SPRE: %d  ORI: %d\n", from, to, ALLMUTS[to]->sop, ori);
 
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return ori;
     }
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = ori;
 
     int i;
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -324,16 +327,16 @@ int __accmut__process_i64_cmp(int from, int to, long left, long right){
     int ori = __accmut__cal_i64_bool(spre , left, right);
 
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return ori;
     }
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = ori;
 
     int i;
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -415,11 +418,11 @@ int __accmut__process_i64_cmp(int from, int to, long left, long right){
 int __accmut__prepare_call(int from, int to, int opnum, ...){
 
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return 0;
     }
 
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = idx;
 
     va_list ap;
@@ -442,7 +445,7 @@ int __accmut__prepare_call(int from, int to, int opnum, ...){
 
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -780,17 +783,17 @@ int __accmut__prepare_st_i32(int from, int to, int tobestore, int* addr){
     *addr = tobestore;
 
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return 0;
     }
 
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = idx;
 
     int i;
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -831,17 +834,17 @@ int __accmut__prepare_st_i64(int from, int to, long tobestore, long* addr){
     *addr = tobestore;
 
     int idx = ALLMUTS[to]->location;
-    if(COVERED_LOCATIONS[idx] > 0){
+    if(ACCMUT_BIT_TEST(COVERED_LOCATIONS, idx)){
         return 0;
     }
 
-    COVERED_LOCATIONS[idx]++;
+    ACCMUT_BIT_SET(COVERED_LOCATIONS, idx);
     ORIRES[idx] = idx;
 
     int i;
     for(i = from; i <= to; ++i) {
 
-        if(UNSUPORTED[i] > 0){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             continue;
         }
 
@@ -932,7 +935,7 @@ static void __accmut__output_set() {
 
         int loci = ALLMUTS[i]->location;
 
-        if(COVERED_LOCATIONS[loci] == 0){
+        if(!ACCMUT_BIT_TEST(COVERED_LOCATIONS, loci)){
             continue;
         }
 
@@ -949,11 +952,11 @@ static void __accmut__output_set() {
         int k;
 
         for(k = i; k <= j; k++){
-            printf("%d ORI: %ld , MUT: %ld, UNSUP: %d\n", k, ORIRES[loci], MUTRES[k], UNSUPORTED[k]);
+            printf("%d ORI: %ld , MUT: %ld, UNSUP: %d\n", k, ORIRES[loci], MUTRES[k], (int)ACCMUT_BIT_TEST(UNSUPORTED, k));
         }
 
         for(k = i; k <= j; k++){
-            if(UNSUPORTED[k] == 1){
+            if(ACCMUT_BIT_TEST(UNSUPORTED, k)){
                 continue;
             }
             if(MUTRES[k] == ORIRES[loci]){
@@ -962,7 +965,7 @@ static void __accmut__output_set() {
             }
             int m;
             for(m = k+1; m <= j; m++){
-                if(UNSUPORTED[k] == 1){
+                if(ACCMUT_BIT_TEST(UNSUPORTED, k)){
                     continue;
                 }
                 if(MUTRES[m] == MUTRES[k]){
@@ -979,10 +982,10 @@ static void __accmut__output_set() {
     for(i = 1; i <= MUT_NUM; ++i) {
         int loci = ALLMUTS[i]->location;
 
-        if(COVERED_LOCATIONS[loci] == 0){
+        if(!ACCMUT_BIT_TEST(COVERED_LOCATIONS, loci)){
             continue;
         }
-        if(UNSUPORTED[i] == 1){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             fprintf(fp, "%d:-1\n", i);
         }else{
             int p = __accmut__find_set(i);
@@ -998,12 +1001,12 @@ static void __accmut__output_set() {
     int total_coved = 0;
     for(i = 1; i <= MUT_NUM; i++){
         int loci = ALLMUTS[i]->location;
-        if(COVERED_LOCATIONS[loci] == 0){
+        if(!ACCMUT_BIT_TEST(COVERED_LOCATIONS, loci)){
             continue;
         }else{
             total_coved++;
         }
-        if(UNSUPORTED[i] == 1){
+        if(ACCMUT_BIT_TEST(UNSUPORTED, i)){
             cbu++;
             continue;
         }
@@ -1026,6 +1029,8 @@ static void __accmut__output_set() {
 
 void __accmut__init(){
 
+    __accmut__test_id_init();
+
     gettimeofday(&tv_begin, NULL);
 
     atexit(__accmut__exit_time);
@@ -1042,10 +1047,35 @@ void __accmut__init(){
 
     int i;
 
+    LOC_NUM = 1;
+    for(i = 1; i <= MUT_NUM; i++){
+        int loc = ALLMUTS[i]->location;
+        if(loc < 0){
+            loc = 0 - loc;
+        }
+        if(loc + 1 > LOC_NUM){
+            LOC_NUM = loc + 1;
+        }
+    }
+
+    COVERED_LOCATIONS = (unsigned long *)calloc(ACCMUT_BITMAP_WORDS(LOC_NUM), sizeof(unsigned long));
+    ORIRES = (long *)calloc(LOC_NUM, sizeof(long));
+    MUTRES = (long *)calloc(MUT_NUM + 1, sizeof(long));
+    UNSUPORTED = (unsigned long *)calloc(ACCMUT_BITMAP_WORDS(MUT_NUM + 1), sizeof(unsigned long));
+    PARENT = (int *)malloc((MUT_NUM + 1) * sizeof(int));
+    if(COVERED_LOCATIONS == NULL || ORIRES == NULL || MUTRES == NULL || UNSUPORTED == NULL || PARENT == NULL){
+        ERRMSG("calloc ERR ");
+        exit(MELLOC_ERR);
+    }
+
     for(i = 1; i <= MUT_NUM; i++){
         if(ALLMUTS[i]->location < 0){
-            UNSUPORTED[i] = 1;
-            ALLMUTS[i]->location = 0 - ALLMUTS[i]->location;
+            ACCMUT_BIT_SET(UNSUPORTED, i);
+            //the embedded table is read only
+            Mutation *m = (Mutation *)malloc(sizeof(Mutation));
+            memcpy(m, ALLMUTS[i], sizeof(Mutation));
+            m->location = 0 - m->location;
+            ALLMUTS[i] = m;
         }
     }
 
@@ -1053,10 +1083,10 @@ void __accmut__init(){
 
         if(ALLMUTS[i]->sop == STSOP || ALLMUTS[i]->sop == CALLSOP){
             if((ALLMUTS[i]->type == STD) || (ALLMUTS[i]->type == LVR)){
-                UNSUPORTED[i] = 1;
+                ACCMUT_BIT_SET(UNSUPORTED, i);
             }else if(ALLMUTS[i]->type == UOI){
                 if(ALLMUTS[i]->op_2 != 2){
-                    UNSUPORTED[i] = 1;
+                    ACCMUT_BIT_SET(UNSUPORTED, i);
                 }
             }
         }
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "accmut_timing.h"
+
+int __accmut__timing_lookup(const char *path, int test_id, AccmutTiming *t){
+
+	int fd = open(path, O_RDONLY);
+	if(fd < 0){
+		return -1;
+	}
+	struct stat sb;
+	if(fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(AccmutTimingHeader)){
+		close(fd);
+		return -1;
+	}
+	void *map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED){
+		return -1;
+	}
+
+	int res = -1;
+	const AccmutTimingHeader *h = (const AccmutTimingHeader *)map;
+	if(h->magic == ACCMUT_TIMING_MAGIC && h->version == ACCMUT_TIMING_VERSION && h->test_num >= 0
+		&& sizeof(AccmutTimingHeader) + sizeof(AccmutTiming) * (size_t)h->test_num <= (size_t)sb.st_size){
+
+		const AccmutTiming *e = (const AccmutTiming *)(h + 1);
+		int lo = 0, hi = h->test_num - 1;
+		while(lo <= hi){
+			int mid = (lo + hi) / 2;
+			if(e[mid].test_id == test_id){
+				*t = e[mid];
+				res = 0;
+				break;
+			}
+			if(e[mid].test_id < test_id){
+				lo = mid + 1;
+			}else{
+				hi = mid - 1;
+			}
+		}
+	}
+
+	munmap(map, sb.st_size);
+	return res;
+}
@@ -0,0 +1,50 @@
+#ifndef ACCMUT_TIMING_H
+#define ACCMUT_TIMING_H
+
+/*
+* The timing index $HOME/tmp/accmut/oritime/<PROJECT>.idx written by
+* utils/calibrate: the run time of the original program on every test,
+* measured over several runs. The entries are sorted by test id.
+*
+* The budget of a forked mutant is the 95th percentile times
+* ACCMUT_TIMEOUT_MULT (3 by default), and at least ACCMUT_TIMEOUT_FLOOR
+* micro seconds (5000 by default), for the cpu time (ITIMER_PROF) and for
+* the wall time (ITIMER_REAL). Without the index the runtime falls back to
+* the old per-test files oritime/<PROJECT>/<TEST_ID>.
+*
+* A program built with ACCMUT_EXEC_BUDGET_INSTRUMENT counts its back edges
+* and function entries instead. A mutant then times out once its count is
+* over exec_count times ACCMUT_EXEC_BUDGET_MULT (10 by default), which does
+* not depend on the load of the host; the wall time budget only stays as a
+* backstop, 10 times the usual one.
+*/
+
+#define ACCMUT_TIMING_MAGIC 0x49544341	/* "ACTI" */
+#define ACCMUT_TIMING_VERSION 2
+
+#define ACCMUT_TIMEOUT_MULT_ENV "ACCMUT_TIMEOUT_MULT"
+#define ACCMUT_TIMEOUT_FLOOR_ENV "ACCMUT_TIMEOUT_FLOOR"
+#define ACCMUT_EXEC_BUDGET_MULT_ENV "ACCMUT_EXEC_BUDGET_MULT"
+
+typedef struct AccmutTimingHeader{
+	unsigned magic;
+	unsigned version;
+	int test_num;
+	int runs;			/* runs per test */
+}AccmutTimingHeader;
+
+typedef struct AccmutTiming{
+	int test_id;
+	int reserved;
+	long cpu_p50;		/* micro seconds, user + sys */
+	long cpu_p95;
+	long real_p50;
+	long real_p95;
+	long real_max;
+	long exec_count;	/* of the original, 0 if the program does not count */
+}AccmutTiming;
+
+/* the entry of the test, 0 if found */
+int __accmut__timing_lookup(const char *path, int test_id, AccmutTiming *t);
+
+#endif
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "accmut_config.h"
+#include "accmut_exitcode.h"
+#include "accmut_vfs.h"
+
+//only linked with accmut_io.o, so stdio is wrapped here: plain system calls
+
+//one allocation per entry, the streams keep pointers to them
+static AccmutVFile **VFILES = NULL;
+static int VFILE_NUM = 0;
+static int VFILE_CAP = 0;
+
+AccmutVFile* __accmut__vfs_lookup(const char *path, int create){
+
+	int i;
+	for(i = 0; i < VFILE_NUM; i++){
+		if(strcmp(VFILES[i]->path, path) == 0){
+			return VFILES[i];
+		}
+	}
+	if(!create){
+		return NULL;
+	}
+
+	if(VFILE_NUM == VFILE_CAP){
+		VFILE_CAP = VFILE_CAP > 0 ? VFILE_CAP * 2 : 16;
+		VFILES = (AccmutVFile **)realloc(VFILES, sizeof(AccmutVFile *) * VFILE_CAP);
+		if(VFILES == NULL){
+			ERRMSG("realloc VFILES ERR");
+			exit(MELLOC_ERR);
+		}
+	}
+	AccmutVFile *f = (AccmutVFile *)calloc(1, sizeof(AccmutVFile));
+	if(f == NULL){
+		ERRMSG("calloc VFILE ERR");
+		exit(MELLOC_ERR);
+	}
+	f->path = strdup(path);
+	VFILES[VFILE_NUM++] = f;
+	return f;
+}
+
+void __accmut__vfs_unlink(const char *path){
+	AccmutVFile *f = __accmut__vfs_lookup(path, 1);
+	if(f->base != NULL && f->len > 0){
+		madvise(f->base, f->len, MADV_DONTNEED);
+	}
+	f->len = 0;
+	f->deleted = 1;
+}
+
+unsigned long __accmut__vfs_hash(const char *buf, size_t len){
+	unsigned long h = 0xcbf29ce484222325UL;
+	size_t i;
+	for(i = 0; i < len; i++){
+		h ^= (unsigned char)buf[i];
+		h *= 0x100000001b3UL;
+	}
+	return h;
+}
+
+static int __accmut__vfs_touched(const AccmutVFile *f){
+	return f->written || f->deleted;
+}
+
+unsigned long __accmut__vfs_digest(){
+
+	unsigned long digest = 0;
+	int i;
+	for(i = 0; i < VFILE_NUM; i++){
+		AccmutVFile *f = VFILES[i];
+		if(!__accmut__vfs_touched(f)){
+			continue;
+		}
+		//the sum does not depend on the order the files were opened in
+		unsigned long h = __accmut__vfs_hash(f->path, strlen(f->path) + 1);
+		if(f->deleted){
+			h = ~h;
+		}else{
+			h ^= __accmut__vfs_hash(f->base, f->len) * 0x100000001b3UL;
+		}
+		digest += h;
+	}
+	return digest;
+}
@@ -0,0 +1,46 @@
+#ifndef ACCMUT_VFS_H
+#define ACCMUT_VFS_H
+
+#include <stddef.h>
+
+/*
+* The overlay of the files the subject writes (see accmut_io.c).
+* A file opened for writing lives in memory, in an entry of this table, and
+* stays there after fclose, so that reading it back or unlinking it never
+* goes to the disk. The table and the buffers are private memory: a forked
+* mutant gets a copy-on-write view of the files of its father and nothing it
+* writes is seen by anyone else. Only the original process (MUTATION_ID 0)
+* also writes the files to disk.
+*
+* A mutant which leaves with the same stdout as the oracle records the
+* digest of the files it has touched (see accmut_result.h), the original
+* compares them with its own once all its mutants are done. A difference
+* kills the mutant like a different stdout. Paths are compared as the
+* subject wrote them.
+*/
+
+typedef struct AccmutVFile{
+	char *path;
+	char *base;		/* anonymous mapping of cap bytes, NULL before the first write */
+	size_t len;
+	size_t cap;
+	int written;	/* opened for writing by this process or its fathers */
+	int deleted;	/* unlinked */
+}AccmutVFile;
+
+/* the entry of path, a new empty one if create, else NULL if there is none */
+AccmutVFile* __accmut__vfs_lookup(const char *path, int create);
+
+/* mark path unlinked, its content is dropped */
+void __accmut__vfs_unlink(const char *path);
+
+/*
+* The digest of all the files written or unlinked, the same for the same
+* contents whatever the order they were opened in.
+*/
+unsigned long __accmut__vfs_digest();
+
+/* 64 bit FNV-1a */
+unsigned long __accmut__vfs_hash(const char *buf, size_t len);
+
+#endif
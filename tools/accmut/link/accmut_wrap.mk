@@ -0,0 +1,10 @@
+# The stdio functions accmut_io.c stands in for. Link the subject with
+# $(WRAP_FLAGS) and accmut_io.o to keep all its stdio in memory.
+
+WRAP_SYMS = fopen fclose feof ferror clearerr fseek ftell rewind fgetpos fsetpos fflush unlink \
+	fgets fgetc getc _IO_getc getchar ungetc fread fscanf scanf __isoc99_fscanf __isoc99_scanf \
+	fputc putc _IO_putc putchar fputs puts fprintf printf vfprintf vprintf fwrite
+
+WRAP_FLAGS = -fno-builtin -U_FORTIFY_SOURCE $(patsubst %,-Wl$(WRAP_COMMA)--wrap=%,$(WRAP_SYMS))
+
+WRAP_COMMA = ,
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+# Benchmark of the concurrent fork scheduler.
+# Runs the same test script under different ACCMUT_JOBS values and reports
+# the wall time of the whole run and the speedup against ACCMUT_JOBS=1.
+#
+# usage: python3 jobsbench.py RUN_TESTS_SCRIPT [JOBS ...]
+# e.g.   python3 jobsbench.py ./runall.sh 1 2 4 8
+#
+# RUN_TESTS_SCRIPT is the script which runs every test of the subject
+# (tcas, printtokens, ...) linked with libamdma.a or libamsche.a. It has not
+# been run on those subjects on a multi-core host yet, see the README.
+
+import os
+import sys
+import time
+import subprocess
+
+if len(sys.argv) < 2:
+	print("usage: python3 jobsbench.py RUN_TESTS_SCRIPT [JOBS ...]")
+	sys.exit(1)
+
+script = sys.argv[1]
+
+if len(sys.argv) > 2:
+	jobs_list = [int(j) for j in sys.argv[2:]]
+else:
+	jobs_list = [1, 2, 4, 8]
+
+if 1 not in jobs_list:
+	jobs_list.insert(0, 1)
+
+
+walltime = {}
+
+for jobs in jobs_list:
+	env = dict(os.environ)
+	env["ACCMUT_JOBS"] = str(jobs)
+	begin = time.time()
+	subprocess.call(script, shell=True, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+	walltime[jobs] = time.time() - begin
+	print("JOBS %d TIME %f s" % (jobs, walltime[jobs]))
+
+print("-------------------------")
+for jobs in jobs_list:
+	speedup = walltime[1] / walltime[jobs]
+	print("JOBS %d SPEEDUP %f EFFICIENCY %f" % (jobs, speedup, speedup / jobs))
+print("-------------------------")
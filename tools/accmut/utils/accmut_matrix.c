@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "accmut_matrix.h"
+#include "accmut_bitmap.h"
+
+int kmat_is_killed(int outcome){
+	switch(outcome){
+		case OUT_KILLED:
+		case OUT_TIMEOUT:
+		case OUT_CRASH:
+		case OUT_EXIT_DIFF:
+		case OUT_RUNNING:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+AccmutResultRegion *kmat_map_region(const char *path, size_t *size){
+	int fd = open(path, O_RDONLY);
+	if(fd < 0){
+		return NULL;
+	}
+	struct stat sb;
+	if(fstat(fd, &sb) < 0 || sb.st_size < (off_t)sizeof(AccmutResultRegion)){
+		close(fd);
+		return NULL;
+	}
+	void *p = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(p == MAP_FAILED){
+		return NULL;
+	}
+	AccmutResultRegion *r = (AccmutResultRegion *)p;
+	if(r->magic != ACCMUT_RES_MAGIC || r->version != ACCMUT_RES_VERSION
+		|| (size_t)sb.st_size < ACCMUT_RES_SIZE(r->mut_num)){
+		munmap(p, sb.st_size);
+		return NULL;
+	}
+	*size = sb.st_size;
+	return r;
+}
+
+unsigned long *kmat_load_coverage(const char *dir, int test_id, int mut_num){
+	char path[512];
+	snprintf(path, sizeof(path), "%s/t%d", dir, test_id);
+	FILE *fp = fopen(path, "rb");
+	if(fp == NULL){
+		return NULL;
+	}
+	long words = ACCMUT_BITMAP_WORDS(mut_num + 1);
+	unsigned long *map = (unsigned long *)calloc(words, sizeof(unsigned long));
+	if(fread(map, sizeof(unsigned long), words, fp) == 0 && ferror(fp)){
+		free(map);
+		map = NULL;
+	}
+	fclose(fp);
+	return map;
+}
+
+static int cmp_int(const void *a, const void *b){
+	return *(const int *)a - *(const int *)b;
+}
+
+KillMatrix *kmat_from_results(const char *dir){
+	DIR *d = opendir(dir);
+	if(d == NULL){
+		fprintf(stderr, "OPEN ERR !! PATH: %s\n", dir);
+		return NULL;
+	}
+
+	int cap = 64, num = 0;
+	int *tids = (int *)malloc(sizeof(int) * cap);
+	struct dirent *e;
+	while((e = readdir(d)) != NULL){
+		int tid;
+		char tail;
+		if(sscanf(e->d_name, "t%d%c", &tid, &tail) != 1){
+			continue;
+		}
+		if(num == cap){
+			cap *= 2;
+			tids = (int *)realloc(tids, sizeof(int) * cap);
+		}
+		tids[num++] = tid;
+	}
+	closedir(d);
+	qsort(tids, num, sizeof(int), cmp_int);
+
+	KillMatrix *km = (KillMatrix *)calloc(1, sizeof(KillMatrix));
+	km->test_ids = (int *)malloc(sizeof(int) * (num > 0 ? num : 1));
+
+	char path[512];
+	int pass;
+	//the first pass finds the mutant num, the second one fills the cells
+	for(pass = 0; pass < 2; pass++){
+		int t = 0;
+		int i;
+		for(i = 0; i < num; i++){
+			snprintf(path, sizeof(path), "%s/t%d", dir, tids[i]);
+			size_t sz;
+			AccmutResultRegion *r = kmat_map_region(path, &sz);
+			if(r == NULL){
+				fprintf(stderr, "INVALID RESULT REGION: %s\n", path);
+				continue;
+			}
+			if(pass == 0){
+				if(r->mut_num > km->mut_num){
+					km->mut_num = r->mut_num;
+				}
+			}else{
+				km->test_ids[t] = tids[i];
+				int ori_exit = r->records[0].exit_code;
+				int m;
+				for(m = 1; m <= r->mut_num; m++){
+					if(r->records[m].key != 0){
+						km->keys[m] = r->records[m].key;
+					}
+				}
+				for(m = 0; m <= r->mut_num; m++){
+					int outcome = __atomic_load_n(&r->records[m].outcome, __ATOMIC_ACQUIRE);
+					if(m > 0 && outcome == OUT_SURVIVED && r->records[m].exit_code != ori_exit){
+						outcome = OUT_EXIT_DIFF;
+					}
+					KMAT_CELL(km, t, m) = outcome;
+				}
+			}
+			t++;
+			munmap(r, sz);
+		}
+		if(pass == 0){
+			km->test_num = t;
+			km->cells = (unsigned char *)calloc((long)(t > 0 ? t : 1) * (km->mut_num + 1), 1);
+			km->keys = (unsigned long *)calloc(km->mut_num + 1, sizeof(unsigned long));
+		}
+	}
+	free(tids);
+	return km;
+}
+
+KillMatrix *kmat_load(const char *path){
+	FILE *fp = fopen(path, "rb");
+	if(fp == NULL){
+		return NULL;
+	}
+	KillMatrixHeader h;
+	if(fread(&h, sizeof(h), 1, fp) != 1 || h.magic != ACCMUT_KMAT_MAGIC
+		|| (h.version != 1 && h.version != ACCMUT_KMAT_VERSION)){
+		fclose(fp);
+		return NULL;
+	}
+	KillMatrix *km = (KillMatrix *)calloc(1, sizeof(KillMatrix));
+	km->test_num = h.test_num;
+	km->mut_num = h.mut_num;
+	km->test_ids = (int *)malloc(sizeof(int) * (h.test_num > 0 ? h.test_num : 1));
+	long cells = (long)h.test_num * (h.mut_num + 1);
+	km->keys = (unsigned long *)calloc(h.mut_num + 1, sizeof(unsigned long));
+	km->cells = (unsigned char *)malloc(cells > 0 ? cells : 1);
+	if(fread(km->test_ids, sizeof(int), h.test_num, fp) != (size_t)h.test_num
+		|| (h.version > 1 && fread(km->keys, sizeof(unsigned long), h.mut_num + 1, fp) != (size_t)h.mut_num + 1)
+		|| fread(km->cells, 1, cells, fp) != (size_t)cells){
+		fclose(fp);
+		kmat_free(km);
+		return NULL;
+	}
+	fclose(fp);
+	return km;
+}
+
+int kmat_save(const KillMatrix *km, const char *path){
+	char tmp[512];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+	FILE *fp = fopen(tmp, "wb");
+	if(fp == NULL){
+		fprintf(stderr, "OPEN ERR !! PATH: %s\n", tmp);
+		return -1;
+	}
+	KillMatrixHeader h;
+	h.magic = ACCMUT_KMAT_MAGIC;
+	h.version = ACCMUT_KMAT_VERSION;
+	h.test_num = km->test_num;
+	h.mut_num = km->mut_num;
+	long cells = (long)km->test_num * (km->mut_num + 1);
+	fwrite(&h, sizeof(h), 1, fp);
+	fwrite(km->test_ids, sizeof(int), km->test_num, fp);
+	if(km->keys != NULL){
+		fwrite(km->keys, sizeof(unsigned long), km->mut_num + 1, fp);
+	}else{
+		unsigned long zero = 0;
+		int m;
+		for(m = 0; m <= km->mut_num; m++){
+			fwrite(&zero, sizeof(zero), 1, fp);
+		}
+	}
+	fwrite(km->cells, 1, cells, fp);
+	if(fclose(fp) != 0){
+		return -1;
+	}
+	return rename(tmp, path);
+}
+
+void kmat_free(KillMatrix *km){
+	if(km == NULL){
+		return;
+	}
+	free(km->test_ids);
+	free(km->keys);
+	free(km->cells);
+	free(km);
+}
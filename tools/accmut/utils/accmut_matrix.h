@@ -0,0 +1,55 @@
+#ifndef ACCMUT_MATRIX_H
+#define ACCMUT_MATRIX_H
+
+#include "accmut_result.h"
+
+/*
+* The test x mutant kill matrix.
+* On disk: the header, test_num test ids, mut_num + 1 stable keys of the
+* columns (see accmut_mutdb.h, 0 for the original and for the mutants with
+* no key), then one byte (AccmutOutcome) per cell, row by row. Column 0 is
+* the original program. Version 1 has no keys, they load as 0.
+*/
+
+#define ACCMUT_KMAT_MAGIC 0x544D4B41	/* "AKMT" */
+#define ACCMUT_KMAT_VERSION 2
+
+typedef struct KillMatrixHeader{
+	unsigned magic;
+	unsigned version;
+	int test_num;
+	int mut_num;
+}KillMatrixHeader;
+
+typedef struct KillMatrix{
+	int test_num;
+	int mut_num;
+	int *test_ids;
+	unsigned long *keys;	/* keys[m] of column m */
+	unsigned char *cells;
+}KillMatrix;
+
+#define KMAT_CELL(km, t, m) ((km)->cells[(long)(t) * ((km)->mut_num + 1) + (m)])
+
+/* whether the outcome kills the mutant */
+int kmat_is_killed(int outcome);
+
+/* build the matrix from all the result regions t<TID> in dir */
+KillMatrix *kmat_from_results(const char *dir);
+
+KillMatrix *kmat_load(const char *path);
+
+int kmat_save(const KillMatrix *km, const char *path);
+
+void kmat_free(KillMatrix *km);
+
+/* map one result region read only, NULL if it is not valid */
+AccmutResultRegion *kmat_map_region(const char *path, size_t *size);
+
+/*
+* the coverage bitmap t<TID> in dir (see accmut_result.h) with mut_num + 1
+* bits, the bits past the end of the file are clear; NULL if there is none
+*/
+unsigned long *kmat_load_coverage(const char *dir, int test_id, int mut_num);
+
+#endif
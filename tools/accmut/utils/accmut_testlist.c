@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accmut_testlist.h"
+
+#define TEST_LINE_MAX 4096
+
+#define BLANKS " \t\r\n"
+
+static int testlist_parse(char *line, AccmutTest *t){
+	char *tok = strtok(line, BLANKS);
+	if(tok == NULL){
+		return 0;
+	}
+
+	memset(t, 0, sizeof(AccmutTest));
+	t->test_id = atoi(tok);
+	t->argv = (char **)malloc(sizeof(char *) * (TEST_LINE_MAX / 2 + 1));
+
+	while((tok = strtok(NULL, BLANKS)) != NULL){
+		if(!strcmp(tok, "<") || !strcmp(tok, ">")){
+			char *path = strtok(NULL, BLANKS);
+			if(path == NULL){
+				break;
+			}
+			if(tok[0] == '<'){
+				t->in = strdup(path);
+			}else{
+				t->out = strdup(path);
+			}
+		}else{
+			t->argv[t->argc++] = strdup(tok);
+		}
+	}
+	t->argv[t->argc] = NULL;
+	t->argv = (char **)realloc(t->argv, sizeof(char *) * (t->argc + 1));
+	return 1;
+}
+
+AccmutTest *testlist_load(const char *path, int *num){
+	FILE *fp = fopen(path, "r");
+	if(fp == NULL){
+		return NULL;
+	}
+
+	int cap = 64;
+	AccmutTest *tests = (AccmutTest *)malloc(sizeof(AccmutTest) * cap);
+	*num = 0;
+
+	char line[TEST_LINE_MAX];
+	while(fgets(line, TEST_LINE_MAX, fp)){
+		if(*num == cap){
+			cap *= 2;
+			tests = (AccmutTest *)realloc(tests, sizeof(AccmutTest) * cap);
+		}
+		if(testlist_parse(line, &tests[*num])){
+			(*num)++;
+		}
+	}
+	fclose(fp);
+	return tests;
+}
+
+int testlist_save(const AccmutTest *tests, const int *order, int num, const char *path){
+	FILE *fp = fopen(path, "w");
+	if(fp == NULL){
+		return -1;
+	}
+	int i, j;
+	for(i = 0; i < num; i++){
+		const AccmutTest *t = &tests[order[i]];
+		fprintf(fp, "%d", t->test_id);
+		for(j = 0; j < t->argc; j++){
+			fprintf(fp, " %s", t->argv[j]);
+		}
+		if(t->in != NULL){
+			fprintf(fp, " < %s", t->in);
+		}
+		if(t->out != NULL){
+			fprintf(fp, " > %s", t->out);
+		}
+		fputc('\n', fp);
+	}
+	return fclose(fp) != 0 ? -1 : 0;
+}
+
+void testlist_free(AccmutTest *tests, int num){
+	int i, j;
+	for(i = 0; i < num; i++){
+		for(j = 0; j < tests[i].argc; j++){
+			free(tests[i].argv[j]);
+		}
+		free(tests[i].argv);
+		free(tests[i].in);
+		free(tests[i].out);
+	}
+	free(tests);
+}
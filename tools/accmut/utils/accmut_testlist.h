@@ -0,0 +1,26 @@
+#ifndef ACCMUT_TESTLIST_H
+#define ACCMUT_TESTLIST_H
+
+/*
+* A test suite, one test per line: the test id, the arguments, and optional
+* "< FILE" and "> FILE" redirections, separated by blanks. Blank lines are
+* skipped.
+*/
+
+typedef struct AccmutTest{
+	int test_id;
+	int argc;
+	char **argv;	/* argc arguments, NULL terminated */
+	char *in;		/* NULL to inherit stdin */
+	char *out;		/* NULL to inherit stdout */
+}AccmutTest;
+
+/* NULL if the file can not be read */
+AccmutTest *testlist_load(const char *path, int *num);
+
+/* write the tests in the given order (indexes of tests), -1 on error */
+int testlist_save(const AccmutTest *tests, const int *order, int num, const char *path);
+
+void testlist_free(AccmutTest *tests, int num);
+
+#endif
@@ -0,0 +1,202 @@
+/*
+* Measures the original program on every test and writes the timing index
+* the runtime derives the timeouts of the mutants from (see
+* link/accmut_timing.h).
+*
+* usage: calibrate [-n RUNS] TESTS PROGRAM INDEX
+*
+*   -n  the runs per test (default 10)
+*
+* TESTS is a test list (see accmut_testlist.h), PROGRAM the instrumented
+* program. It runs the arguments of every test with the id in ACCMUT_TEST_ID
+* and ACCMUT_MUTANTS=0-0, so only the original runs, with
+* the same instrumentation overhead as the mutants. The runs are serial so
+* that they do not disturb each other. A program built with
+* ACCMUT_EXEC_BUDGET_INSTRUMENT also reports its exec count, the highest of
+* the runs goes into the index. INDEX is usually
+* $HOME/tmp/accmut/oritime/<PROJECT>.idx.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "accmut_matrix.h"
+#include "accmut_timing.h"
+#include "accmut_testlist.h"
+
+static int RUNS = 10;
+
+static char RESULT_PATH[64];
+
+static void redirect(const char *path, int fd, int flags){
+	int nfd = open(path, flags, 0644);
+	if(nfd < 0){
+		perror(path);
+		_exit(127);
+	}
+	dup2(nfd, fd);
+	close(nfd);
+}
+
+/* run the test once, cpu and wall time in micro seconds, the highest exec count */
+static int run_once(const char *prog, const AccmutTest *t, long *cpu, long *real, long *count){
+	struct timespec begin, end;
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+
+	pid_t pid = fork();
+	if(pid < 0){
+		perror("fork");
+		exit(1);
+	}
+	if(pid == 0){
+		char id[16];
+		snprintf(id, sizeof(id), "%d", t->test_id);
+		setenv(ACCMUT_TEST_ID_ENV, id, 1);
+		setenv(ACCMUT_MUTANTS_ENV, "0-0", 1);
+		setenv(ACCMUT_RESULT_FILE_ENV, RESULT_PATH, 1);
+		redirect(t->in != NULL ? t->in : "/dev/null", STDIN_FILENO, O_RDONLY);
+		redirect(t->out != NULL ? t->out : "/dev/null", STDOUT_FILENO, O_WRONLY | O_CREAT | O_TRUNC);
+
+		char **argv = (char **)malloc(sizeof(char *) * (t->argc + 2));
+		argv[0] = (char *)prog;
+		memcpy(argv + 1, t->argv, sizeof(char *) * (t->argc + 1));
+		execv(prog, argv);
+		perror(prog);
+		_exit(127);
+	}
+
+	int status;
+	struct rusage ru;
+	if(wait4(pid, &status, 0, &ru) < 0){
+		perror("wait4");
+		exit(1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	//the count of the original, if the program counts
+	size_t sz;
+	AccmutResultRegion *r = kmat_map_region(RESULT_PATH, &sz);
+	if(r != NULL){
+		if(r->records[0].exec_count > *count){
+			*count = r->records[0].exec_count;
+		}
+		munmap(r, sz);
+	}
+
+	*cpu = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000L
+			+ ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+	*real = (end.tv_sec - begin.tv_sec) * 1000000L + (end.tv_nsec - begin.tv_nsec) / 1000;
+	return status;
+}
+
+static int cmp_long(const void *a, const void *b){
+	long x = *(const long *)a, y = *(const long *)b;
+	return x < y ? -1 : x > y;
+}
+
+static int cmp_timing(const void *a, const void *b){
+	return ((const AccmutTiming *)a)->test_id - ((const AccmutTiming *)b)->test_id;
+}
+
+/* nearest rank percentile of n sorted values */
+static long percentile(const long *v, int n, int p){
+	int rank = (p * n + 99) / 100;
+	return v[rank > 0 ? rank - 1 : 0];
+}
+
+int main(int argc, char **argv){
+	int opt;
+	while((opt = getopt(argc, argv, "n:")) != -1){
+		if(opt == 'n' && atoi(optarg) > 0){
+			RUNS = atoi(optarg);
+		}else{
+			fprintf(stderr, "usage: %s [-n RUNS] TESTS PROGRAM INDEX\n", argv[0]);
+			return 1;
+		}
+	}
+	if(argc - optind != 3){
+		fprintf(stderr, "usage: %s [-n RUNS] TESTS PROGRAM INDEX\n", argv[0]);
+		return 1;
+	}
+	const char *prog = argv[optind + 1];
+	const char *index_path = argv[optind + 2];
+
+	int num;
+	AccmutTest *tests = testlist_load(argv[optind], &num);
+	if(tests == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", argv[optind]);
+		return 1;
+	}
+
+	//the result region of the runs is thrown away
+	strcpy(RESULT_PATH, "/tmp/accmut_calibrate.XXXXXX");
+	int fd = mkstemp(RESULT_PATH);
+	if(fd < 0){
+		perror("mkstemp");
+		return 1;
+	}
+	close(fd);
+
+	AccmutTiming *timings = (AccmutTiming *)calloc(num > 0 ? num : 1, sizeof(AccmutTiming));
+	long *cpu = (long *)malloc(sizeof(long) * RUNS);
+	long *real = (long *)malloc(sizeof(long) * RUNS);
+
+	int i, r;
+	for(i = 0; i < num; i++){
+		for(r = 0; r < RUNS; r++){
+			int status = run_once(prog, &tests[i], &cpu[r], &real[r], &timings[i].exec_count);
+			if(WIFSIGNALED(status)){
+				fprintf(stderr, "WARNING : TEST %d KILLED BY SIGNAL %d\n", tests[i].test_id, WTERMSIG(status));
+			}
+		}
+		qsort(cpu, RUNS, sizeof(long), cmp_long);
+		qsort(real, RUNS, sizeof(long), cmp_long);
+
+		AccmutTiming *t = &timings[i];
+		t->test_id = tests[i].test_id;
+		t->cpu_p50 = percentile(cpu, RUNS, 50);
+		t->cpu_p95 = percentile(cpu, RUNS, 95);
+		t->real_p50 = percentile(real, RUNS, 50);
+		t->real_p95 = percentile(real, RUNS, 95);
+		t->real_max = real[RUNS - 1];
+
+		printf("%d\tcpu %ld/%ld\treal %ld/%ld/%ld\tcount %ld\n", t->test_id, t->cpu_p50, t->cpu_p95,
+			t->real_p50, t->real_p95, t->real_max, t->exec_count);
+	}
+	unlink(RESULT_PATH);
+
+	qsort(timings, num, sizeof(AccmutTiming), cmp_timing);
+
+	AccmutTimingHeader h;
+	h.magic = ACCMUT_TIMING_MAGIC;
+	h.version = ACCMUT_TIMING_VERSION;
+	h.test_num = num;
+	h.runs = RUNS;
+
+	char tmp[512];
+	snprintf(tmp, sizeof(tmp), "%s.tmp", index_path);
+	FILE *fp = fopen(tmp, "wb");
+	if(fp == NULL){
+		fprintf(stderr, "OPEN ERR !! PATH: %s\n", tmp);
+		return 1;
+	}
+	fwrite(&h, sizeof(h), 1, fp);
+	fwrite(timings, sizeof(AccmutTiming), num, fp);
+	if(fclose(fp) != 0 || rename(tmp, index_path) != 0){
+		fprintf(stderr, "WRITE ERR !! PATH: %s\n", index_path);
+		return 1;
+	}
+
+	free(cpu);
+	free(real);
+	free(timings);
+	testlist_free(tests, num);
+	return 0;
+}
@@ -0,0 +1,518 @@
+/*
+* Runs a mutation testing campaign on a meta-mutant, the mutant by mutant
+* baseline AccMut is compared against.
+*
+* usage: campaign [-j JOBS] [-g GROUP] [-m FROM-TO[,FROM-TO...]] [-t SECONDS]
+*                 [-b BUILD_CMD] [-c COVERAGE_DIR] [-k BASE_MATRIX] [-o MATRIX]
+*                 TESTS PROGRAM
+*
+*   -j  the processes running at the same time, one per online cpu by default
+*   -g  the mutants of one work item, all the mutants in one item by default
+*   -m  the mutants of the campaign, all the mutants of mutations.txt by default
+*       (the ranges of a group never span two ranges)
+*   -t  the wall time limit of a work item, 0 for no limit (default 60)
+*   -b  the command building PROGRAM, run once before the tests
+*   -c  the coverage bitmaps t<TID> of the tests (see accmut_result.h), the
+*       items none of whose mutants the test reaches are not run
+*   -k  the cells of the mutants out of -m come from this matrix, e.g. the
+*       one of carryover after an incremental generation
+*   -o  the kill matrix written at the end (default campaign.kmat)
+*
+* TESTS is a test list (see accmut_testlist.h). PROGRAM is built once with
+* all the mutants. Every (test, group of mutants) is a work item: PROGRAM
+* runs the arguments of the test with its id in ACCMUT_TEST_ID (see
+* accmut_result.h), ACCMUT_MUTANTS set to the group, and the runtime writes
+* the records of the group to a region of its own (ACCMUT_RESULT_FILE).
+* An item over the time limit is killed with all its processes, the
+* mutants of it that did not finish are timeouts. At the end the regions
+* are put together into one kill matrix (see accmut_matrix.h).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "accmut_matrix.h"
+#include "accmut_testlist.h"
+#include "accmut_forksrv.h"
+#include "accmut_bitmap.h"
+
+typedef struct WorkItem{
+	int test;		/* index in the test list */
+	int from;
+	int to;
+	pid_t pid;			/* and the process group */
+	int exited;
+	int timed_out;
+	int first;			/* the first item of its test, reports the original */
+	int not_covered;	/* not run, the test reaches none of the mutants */
+	struct timespec start;
+}WorkItem;
+
+static int JOBS = 0;
+static int GROUP = 0;
+typedef struct MutRange{
+	int from;
+	int to;
+}MutRange;
+
+static MutRange *RANGES = NULL;
+static int RANGE_NUM = 0;
+static int MUT_NUM = 0;		/* the columns of the matrix */
+static const char *BASE_PATH = NULL;
+static double TIMEOUT = 60;
+static const char *BUILD_CMD = NULL;
+static const char *COVERAGE_DIR = NULL;
+static const char *MATRIX_PATH = "campaign.kmat";
+static const char *PROGRAM = NULL;
+
+static AccmutTest *TESTS = NULL;
+static int TEST_NUM = 0;
+
+static WorkItem *ITEMS = NULL;
+static int ITEM_NUM = 0;
+
+static char PART_DIR[256];
+
+/* FROM-TO[,FROM-TO...], 0 if valid */
+static int parse_ranges(const char *arg){
+	int cap = 4, n;
+	RANGES = (MutRange *)malloc(sizeof(MutRange) * cap);
+	RANGE_NUM = 0;
+	while(1){
+		if(RANGE_NUM == cap){
+			cap *= 2;
+			RANGES = (MutRange *)realloc(RANGES, sizeof(MutRange) * cap);
+		}
+		MutRange *r = &RANGES[RANGE_NUM];
+		if(sscanf(arg, "%d-%d%n", &r->from, &r->to, &n) != 2 || r->from < 1 || r->from > r->to){
+			return -1;
+		}
+		RANGE_NUM++;
+		arg += n;
+		if(*arg != ','){
+			break;
+		}
+		arg++;
+	}
+	return *arg == '\0' ? 0 : -1;
+}
+
+static int count_mutants(){
+	char path[256];
+	snprintf(path, sizeof(path), "%s/tmp/accmut/mutations.txt", getenv("HOME"));
+	FILE *fp = fopen(path, "r");
+	if(fp == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s, GIVE THE MUTANTS WITH -m\n", path);
+		exit(1);
+	}
+	int n = 0;
+	char buff[256];
+	while(fgets(buff, sizeof(buff), fp)){
+		if(buff[0] != '\n'){
+			n++;
+		}
+	}
+	fclose(fp);
+	return n;
+}
+
+static int any_covered(const unsigned long *map, int from, int to){
+	int m;
+	for(m = from; m <= to; m++){
+		if(ACCMUT_BIT_TEST(map, m)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void part_path(const WorkItem *w, char *path, size_t len){
+	snprintf(path, len, "%s/t%d_%d", PART_DIR, TESTS[w->test].test_id, w->from);
+}
+
+static double elapsed(const struct timespec *since){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - since->tv_sec) + (now.tv_nsec - since->tv_nsec) / 1e9;
+}
+
+static void redirect(const char *path, int fd, int flags){
+	int nfd = open(path, flags, 0644);
+	if(nfd < 0){
+		perror(path);
+		_exit(127);
+	}
+	dup2(nfd, fd);
+	close(nfd);
+}
+
+static void launch(WorkItem *w){
+	const AccmutTest *t = &TESTS[w->test];
+
+	pid_t pid = fork();
+	if(pid < 0){
+		perror("fork");
+		exit(1);
+	}
+	if(pid == 0){
+		//the item and all the mutants it forks are killed together
+		setpgid(0, 0);
+
+		char env[64];
+		snprintf(env, sizeof(env), "%d-%d", w->from, w->to);
+		setenv(ACCMUT_MUTANTS_ENV, env, 1);
+		snprintf(env, sizeof(env), "%d", t->test_id);
+		setenv(ACCMUT_TEST_ID_ENV, env, 1);
+		char path[512];
+		part_path(w, path, sizeof(path));
+		setenv(ACCMUT_RESULT_FILE_ENV, path, 1);
+		unsetenv(ACCMUT_FORKSRV_ENV);
+
+		if(t->in != NULL){
+			redirect(t->in, STDIN_FILENO, O_RDONLY);
+		}
+		if(t->out != NULL && ITEM_NUM == TEST_NUM){
+			redirect(t->out, STDOUT_FILENO, O_WRONLY | O_CREAT | O_TRUNC);
+		}else if(t->out != NULL){
+			//the groups of a test do not write the same file
+			snprintf(path, sizeof(path), "%s.%d", t->out, w->from);
+			redirect(path, STDOUT_FILENO, O_WRONLY | O_CREAT | O_TRUNC);
+		}else{
+			redirect("/dev/null", STDOUT_FILENO, O_WRONLY);
+		}
+
+		char **argv = (char **)malloc(sizeof(char *) * (t->argc + 2));
+		argv[0] = (char *)PROGRAM;
+		memcpy(argv + 1, t->argv, sizeof(char *) * (t->argc + 1));
+		execv(PROGRAM, argv);
+		perror(PROGRAM);
+		_exit(127);
+	}
+
+	setpgid(pid, pid);
+	w->pid = pid;
+	clock_gettime(CLOCK_MONOTONIC, &w->start);
+}
+
+/* reap everything, the orphaned mutants of the items come back to us */
+static void reap(WorkItem **running, int run_num){
+	int status;
+	pid_t pid;
+	while((pid = waitpid(-1, &status, WNOHANG)) > 0){
+		int i;
+		for(i = 0; i < run_num; i++){
+			if(running[i]->pid == pid){
+				running[i]->exited = 1;
+			}
+		}
+	}
+}
+
+static void run_items(){
+	WorkItem **running = (WorkItem **)calloc(JOBS, sizeof(WorkItem *));
+	int run_num = 0;
+	int next = 0;
+
+	prctl(PR_SET_CHILD_SUBREAPER, 1);
+
+	while(next < ITEM_NUM || run_num > 0){
+
+		while(run_num < JOBS && next < ITEM_NUM){
+			if(ITEMS[next].not_covered){
+				next++;
+				continue;
+			}
+			launch(&ITEMS[next]);
+			running[run_num++] = &ITEMS[next];
+			next++;
+		}
+
+		reap(running, run_num);
+
+		int i;
+		for(i = 0; i < run_num; i++){
+			WorkItem *w = running[i];
+			//an item is done when all the processes of its group are gone
+			if(w->exited && kill(-w->pid, 0) < 0 && errno == ESRCH){
+				running[i--] = running[--run_num];
+				continue;
+			}
+			if(TIMEOUT > 0 && !w->timed_out && elapsed(&w->start) > TIMEOUT){
+				w->timed_out = 1;
+				kill(-w->pid, SIGKILL);
+			}
+		}
+
+		struct timespec ts = {0, 1000000};
+		nanosleep(&ts, NULL);
+	}
+	free(running);
+}
+
+/* the records of all the items into one matrix */
+static KillMatrix *merge_items(){
+	KillMatrix *km = (KillMatrix *)calloc(1, sizeof(KillMatrix));
+	km->test_num = TEST_NUM;
+	km->mut_num = MUT_NUM;
+	km->test_ids = (int *)malloc(sizeof(int) * (TEST_NUM > 0 ? TEST_NUM : 1));
+	km->keys = (unsigned long *)calloc(MUT_NUM + 1, sizeof(unsigned long));
+	km->cells = (unsigned char *)calloc((long)(TEST_NUM > 0 ? TEST_NUM : 1) * (MUT_NUM + 1), 1);
+
+	int i;
+	for(i = 0; i < TEST_NUM; i++){
+		km->test_ids[i] = TESTS[i].test_id;
+	}
+
+	KillMatrix *base = BASE_PATH != NULL ? kmat_load(BASE_PATH) : NULL;
+	if(base != NULL){
+		int r, m;
+		for(m = 1; m <= base->mut_num && m <= km->mut_num; m++){
+			km->keys[m] = base->keys[m];
+		}
+		for(i = 0; i < TEST_NUM; i++){
+			for(r = 0; r < base->test_num && base->test_ids[r] != km->test_ids[i]; r++);
+			for(m = 0; r < base->test_num && m <= base->mut_num && m <= km->mut_num; m++){
+				KMAT_CELL(km, i, m) = KMAT_CELL(base, r, m);
+			}
+		}
+		kmat_free(base);
+	}
+
+	for(i = 0; i < ITEM_NUM; i++){
+		WorkItem *w = &ITEMS[i];
+		if(w->not_covered){
+			int m;
+			for(m = w->from; m <= w->to; m++){
+				KMAT_CELL(km, w->test, m) = OUT_NOT_COVERED;
+			}
+			continue;
+		}
+		char path[512];
+		part_path(w, path, sizeof(path));
+
+		size_t sz;
+		AccmutResultRegion *r = kmat_map_region(path, &sz);
+		if(r == NULL){
+			fprintf(stderr, "NO RESULTS OF TEST %d MUTANTS %d-%d\n", TESTS[w->test].test_id, w->from, w->to);
+			if(w->timed_out){
+				int m;
+				for(m = w->from; m <= w->to; m++){
+					KMAT_CELL(km, w->test, m) = OUT_TIMEOUT;
+				}
+			}
+			continue;
+		}
+
+		//every item runs the original too, the first one reports it
+		int ori_exit = r->records[0].exit_code;
+		if(w->first){
+			KMAT_CELL(km, w->test, 0) = r->records[0].outcome;
+		}
+
+		//every region has the keys of all the mutants
+		int m;
+		for(m = 1; m <= r->mut_num && m <= km->mut_num; m++){
+			if(r->records[m].key != 0){
+				km->keys[m] = r->records[m].key;
+			}
+		}
+		for(m = w->from; m <= w->to && m <= r->mut_num; m++){
+			int outcome = __atomic_load_n(&r->records[m].outcome, __ATOMIC_ACQUIRE);
+			if(outcome == OUT_SURVIVED && r->records[m].exit_code != ori_exit){
+				outcome = OUT_EXIT_DIFF;
+			}
+			if(w->timed_out && (outcome == OUT_NOT_RUN || outcome == OUT_RUNNING)){
+				outcome = OUT_TIMEOUT;
+			}
+			KMAT_CELL(km, w->test, m) = outcome;
+		}
+
+		munmap(r, sz);
+		unlink(path);
+	}
+	rmdir(PART_DIR);
+	return km;
+}
+
+static void usage(const char *prog){
+	fprintf(stderr, "usage: %s [-j JOBS] [-g GROUP] [-m FROM-TO[,FROM-TO...]] [-t SECONDS] [-b BUILD_CMD] [-c COVERAGE_DIR] [-k BASE_MATRIX] [-o MATRIX] TESTS PROGRAM\n", prog);
+	exit(1);
+}
+
+int main(int argc, char **argv){
+	int opt;
+	while((opt = getopt(argc, argv, "j:g:m:t:b:c:k:o:")) != -1){
+		switch(opt){
+			case 'j':
+				JOBS = atoi(optarg);
+				break;
+			case 'g':
+				GROUP = atoi(optarg);
+				break;
+			case 'm':
+				if(parse_ranges(optarg) != 0){
+					usage(argv[0]);
+				}
+				break;
+			case 't':
+				TIMEOUT = atof(optarg);
+				break;
+			case 'b':
+				BUILD_CMD = optarg;
+				break;
+			case 'c':
+				COVERAGE_DIR = optarg;
+				break;
+			case 'k':
+				BASE_PATH = optarg;
+				break;
+			case 'o':
+				MATRIX_PATH = optarg;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+	if(argc - optind != 2){
+		usage(argv[0]);
+	}
+	PROGRAM = argv[optind + 1];
+
+	if(JOBS <= 0){
+		JOBS = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	TESTS = testlist_load(argv[optind], &TEST_NUM);
+	if(TESTS == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", argv[optind]);
+		return 1;
+	}
+
+	struct timeval tv_begin, tv_end;
+	gettimeofday(&tv_begin, NULL);
+
+	//the meta-mutant is built once, not once per mutant
+	if(BUILD_CMD != NULL && system(BUILD_CMD) != 0){
+		fprintf(stderr, "BUILD FAILED: %s\n", BUILD_CMD);
+		return 1;
+	}
+
+	if(RANGE_NUM == 0){
+		RANGES = (MutRange *)malloc(sizeof(MutRange));
+		RANGES[0].from = 1;
+		RANGES[0].to = count_mutants();
+		RANGE_NUM = 1;
+	}
+	int r, muts = 0, max_range = 0;
+	for(r = 0; r < RANGE_NUM; r++){
+		int size = RANGES[r].to - RANGES[r].from + 1;
+		muts += size;
+		if(size > max_range){
+			max_range = size;
+		}
+		if(RANGES[r].to > MUT_NUM){
+			MUT_NUM = RANGES[r].to;
+		}
+	}
+	if(BASE_PATH != NULL){
+		KillMatrix *base = kmat_load(BASE_PATH);
+		if(base == NULL){
+			fprintf(stderr, "CAN NOT LOAD MATRIX %s\n", BASE_PATH);
+			return 1;
+		}
+		if(base->mut_num > MUT_NUM){
+			MUT_NUM = base->mut_num;
+		}
+		kmat_free(base);
+	}
+	if(GROUP <= 0){
+		GROUP = max_range;
+	}
+
+	int groups = 0;
+	for(r = 0; r < RANGE_NUM; r++){
+		groups += (RANGES[r].to - RANGES[r].from + GROUP) / GROUP;
+	}
+	ITEM_NUM = TEST_NUM * groups;
+	ITEMS = (WorkItem *)calloc(ITEM_NUM > 0 ? ITEM_NUM : 1, sizeof(WorkItem));
+	int t, n = 0, not_covered = 0;
+	for(t = 0; t < TEST_NUM; t++){
+		unsigned long *cov = COVERAGE_DIR != NULL ? kmat_load_coverage(COVERAGE_DIR, TESTS[t].test_id, MUT_NUM) : NULL;
+		int first = n;
+		for(r = 0; r < RANGE_NUM; r++){
+			int from;
+			for(from = RANGES[r].from; from <= RANGES[r].to; from += GROUP){
+				ITEMS[n].test = t;
+				ITEMS[n].first = n == first;
+				ITEMS[n].from = from;
+				ITEMS[n].to = from + GROUP - 1;
+				if(ITEMS[n].to > RANGES[r].to){
+					ITEMS[n].to = RANGES[r].to;
+				}
+				//the first group also runs the original for the matrix
+				if(cov != NULL && !ITEMS[n].first && !any_covered(cov, ITEMS[n].from, ITEMS[n].to)){
+					ITEMS[n].not_covered = 1;
+					not_covered++;
+				}
+				n++;
+			}
+		}
+		free(cov);
+	}
+
+	snprintf(PART_DIR, sizeof(PART_DIR), "%s.parts", MATRIX_PATH);
+	if(mkdir(PART_DIR, 0755) < 0 && errno != EEXIST){
+		perror(PART_DIR);
+		return 1;
+	}
+
+	run_items();
+
+	KillMatrix *km = merge_items();
+	if(kmat_save(km, MATRIX_PATH) != 0){
+		fprintf(stderr, "CAN NOT WRITE %s\n", MATRIX_PATH);
+		return 1;
+	}
+
+	int timeouts = 0, killed = 0;
+	int i, m;
+	for(i = 0; i < ITEM_NUM; i++){
+		timeouts += ITEMS[i].timed_out;
+	}
+	for(m = 1; m <= km->mut_num; m++){
+		for(i = 0; i < TEST_NUM; i++){
+			if(kmat_is_killed(KMAT_CELL(km, i, m))){
+				killed++;
+				break;
+			}
+		}
+	}
+
+	gettimeofday(&tv_end, NULL);
+	long real_sec =  tv_end.tv_sec - tv_begin.tv_sec;
+	long real_usec = tv_end.tv_usec - tv_begin.tv_usec;
+	if(real_usec < 0){
+		real_sec--;
+		real_usec += 1000000;
+	}
+
+	fprintf(stderr, "TESTS: %d MUTANTS: %d RUN: %d ITEMS: %d NOT COVERED ITEMS: %d TIMEOUT ITEMS: %d KILLED: %d\n",
+		TEST_NUM, km->mut_num, muts, ITEM_NUM, not_covered, timeouts, killed);
+	fprintf(stderr, "TOTAL TIME: %ld %ld\n", real_sec, real_usec);
+
+	kmat_free(km);
+	testlist_free(TESTS, TEST_NUM);
+	free(ITEMS);
+	free(RANGES);
+	return 0;
+}
@@ -0,0 +1,266 @@
+/*
+* Carries the kill results of the mutants of the unchanged functions over to
+* the mutants generated again after a change of the program.
+*
+* usage: carryover PREV_DIR PREV_MATRIX OUT_MATRIX
+*
+* PREV_DIR holds the funchash.txt and the mutations.txt of the last
+* generation (see MutationIncr.h), the new ones are in $HOME/tmp/accmut.
+* PREV_MATRIX is the kill matrix of the last campaign. A function is
+* affected if its hash is not the same, if it is new, or if it calls an
+* affected or a removed function, directly or not. The mutants of the
+* functions that are not affected, with the same lines in both
+* mutations.txt, keep their cells under their new ids; the mutants of the
+* affected functions are stale. OUT_MATRIX is the matrix of the new mutants
+* with the stale columns OUT_NOT_RUN, the stale ranges are printed as
+* FROM-TO,FROM-TO,... for campaign -m (nothing if none), e.g.
+*   campaign -k OUT_MATRIX -m `carryover PREV_DIR PREV_MATRIX OUT_MATRIX` ...
+* A change of a caller may still change the results of a function that is
+* not affected, as may a change of a global or of a function called through
+* a pointer.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accmut_matrix.h"
+#include "accmut_mutdb.h"
+
+#define LINE_MAX_LEN 4096
+
+typedef struct FuncInfo{
+	char *name;
+	char hash[64];
+	char *callees;		/* "-" if none */
+	int first;			/* the first mutant in mutations.txt, 0 if none */
+	int count;
+	int affected;
+}FuncInfo;
+
+typedef struct Generation{
+	FuncInfo *funcs;
+	int func_num;
+	char **lines;		/* mutant i is lines[i - 1] */
+	int mut_num;
+}Generation;
+
+static FuncInfo *find_func(Generation *g, const char *name){
+	int i;
+	for(i = 0; i < g->func_num; i++){
+		if(!strcmp(g->funcs[i].name, name)){
+			return &g->funcs[i];
+		}
+	}
+	return NULL;
+}
+
+static FuncInfo *add_func(Generation *g, const char *name, int *cap){
+	if(g->func_num == *cap){
+		*cap = *cap > 0 ? *cap * 2 : 64;
+		g->funcs = (FuncInfo *)realloc(g->funcs, sizeof(FuncInfo) * *cap);
+	}
+	FuncInfo *f = &g->funcs[g->func_num++];
+	memset(f, 0, sizeof(FuncInfo));
+	f->name = strdup(name);
+	f->callees = strdup("-");
+	return f;
+}
+
+static int load_generation(const char *dir, Generation *g){
+	char path[512], line[LINE_MAX_LEN];
+	int cap = 0, line_cap = 0;
+	memset(g, 0, sizeof(Generation));
+
+	snprintf(path, sizeof(path), "%s/funchash.txt", dir);
+	FILE *fp = fopen(path, "r");
+	if(fp == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", path);
+		return -1;
+	}
+	char name[LINE_MAX_LEN], hash[64], callees[LINE_MAX_LEN];
+	while(fgets(line, sizeof(line), fp)){
+		if(sscanf(line, "%s %63s %s", name, hash, callees) != 3){
+			continue;
+		}
+		FuncInfo *f = find_func(g, name);
+		if(f == NULL){
+			f = add_func(g, name, &cap);
+		}
+		strcpy(f->hash, hash);
+		free(f->callees);
+		f->callees = strdup(callees);
+	}
+	fclose(fp);
+
+	snprintf(path, sizeof(path), "%s/mutations.txt", dir);
+	fp = fopen(path, "r");
+	if(fp == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", path);
+		return -1;
+	}
+	while(fgets(line, sizeof(line), fp)){
+		if(line[0] == '\n' || sscanf(line, "%*[^:]:%[^:]:", name) != 1){
+			continue;
+		}
+		if(g->mut_num == line_cap){
+			line_cap = line_cap > 0 ? line_cap * 2 : 1024;
+			g->lines = (char **)realloc(g->lines, sizeof(char *) * line_cap);
+		}
+		g->lines[g->mut_num++] = strdup(line);
+
+		//the mutants of a function are always together
+		FuncInfo *f = find_func(g, name);
+		if(f == NULL){
+			f = add_func(g, name, &cap);
+		}
+		if(f->count == 0){
+			f->first = g->mut_num;
+		}
+		f->count++;
+	}
+	fclose(fp);
+	return 0;
+}
+
+/* whether f calls a function that is affected or not there anymore */
+static int calls_affected(Generation *prev, Generation *cur, const FuncInfo *f){
+	if(!strcmp(f->callees, "-")){
+		return 0;
+	}
+	char *list = strdup(f->callees);
+	char *save, *name;
+	int res = 0;
+	for(name = strtok_r(list, ",", &save); name != NULL && !res; name = strtok_r(NULL, ",", &save)){
+		FuncInfo *c = find_func(cur, name);
+		//the library functions are in neither
+		res = c != NULL ? c->affected : find_func(prev, name) != NULL;
+	}
+	free(list);
+	return res;
+}
+
+static void mark_affected(Generation *prev, Generation *cur){
+	int i;
+	for(i = 0; i < cur->func_num; i++){
+		FuncInfo *f = &cur->funcs[i];
+		FuncInfo *p = find_func(prev, f->name);
+		f->affected = p == NULL || f->hash[0] == '\0' || strcmp(p->hash, f->hash) != 0;
+	}
+	int changed = 1;
+	while(changed){
+		changed = 0;
+		for(i = 0; i < cur->func_num; i++){
+			FuncInfo *f = &cur->funcs[i];
+			if(!f->affected && calls_affected(prev, cur, f)){
+				f->affected = 1;
+				changed = 1;
+			}
+		}
+	}
+}
+
+/* whether the mutants of f are the same in both generations */
+static int same_mutants(Generation *prev, Generation *cur, const FuncInfo *f, const FuncInfo *p){
+	if(p == NULL || p->count != f->count){
+		return 0;
+	}
+	int i;
+	for(i = 0; i < f->count; i++){
+		if(strcmp(prev->lines[p->first - 1 + i], cur->lines[f->first - 1 + i]) != 0){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int main(int argc, char **argv){
+	if(argc != 4){
+		fprintf(stderr, "usage: carryover PREV_DIR PREV_MATRIX OUT_MATRIX\n");
+		return 1;
+	}
+
+	char dir[512];
+	snprintf(dir, sizeof(dir), "%s/tmp/accmut", getenv("HOME"));
+
+	Generation prev, cur;
+	if(load_generation(argv[1], &prev) != 0 || load_generation(dir, &cur) != 0){
+		return 1;
+	}
+	KillMatrix *old = kmat_load(argv[2]);
+	if(old == NULL){
+		fprintf(stderr, "CAN NOT LOAD MATRIX %s\n", argv[2]);
+		return 1;
+	}
+	if(old->mut_num != prev.mut_num){
+		fprintf(stderr, "MATRIX %s HAS %d MUTANTS, %s/mutations.txt HAS %d\n",
+			argv[2], old->mut_num, argv[1], prev.mut_num);
+		return 1;
+	}
+
+	mark_affected(&prev, &cur);
+
+	int t, i, m;
+	KillMatrix *km = (KillMatrix *)calloc(1, sizeof(KillMatrix));
+	km->test_num = old->test_num;
+	km->mut_num = cur.mut_num;
+	km->test_ids = (int *)malloc(sizeof(int) * (old->test_num > 0 ? old->test_num : 1));
+	memcpy(km->test_ids, old->test_ids, sizeof(int) * old->test_num);
+	km->keys = (unsigned long *)calloc(cur.mut_num + 1, sizeof(unsigned long));
+	for(m = 1; m <= cur.mut_num; m++){
+		km->keys[m] = __accmut__mutdb_parse_key(cur.lines[m - 1]);
+	}
+	km->cells = (unsigned char *)calloc((long)(km->test_num > 0 ? km->test_num : 1) * (km->mut_num + 1), 1);
+
+	for(t = 0; t < km->test_num; t++){
+		KMAT_CELL(km, t, 0) = KMAT_CELL(old, t, 0);
+	}
+
+	char *is_stale = (char *)calloc(cur.mut_num + 1, 1);
+	int carried = 0, stale = 0, affected = 0;
+	for(i = 0; i < cur.func_num; i++){
+		FuncInfo *f = &cur.funcs[i];
+		affected += f->affected;
+		if(f->count == 0){
+			continue;
+		}
+		FuncInfo *p = find_func(&prev, f->name);
+		if(!f->affected && same_mutants(&prev, &cur, f, p)){
+			for(t = 0; t < km->test_num; t++){
+				for(m = 0; m < f->count; m++){
+					KMAT_CELL(km, t, f->first + m) = KMAT_CELL(old, t, p->first + m);
+				}
+			}
+			carried += f->count;
+		}else{
+			memset(is_stale + f->first, 1, f->count);
+			stale += f->count;
+		}
+	}
+
+	//the stale mutants as ranges
+	int printed = 0;
+	for(m = 1; m <= cur.mut_num; m++){
+		if(!is_stale[m]){
+			continue;
+		}
+		int from = m;
+		while(m < cur.mut_num && is_stale[m + 1]){
+			m++;
+		}
+		printf("%s%d-%d", printed++ ? "," : "", from, m);
+	}
+	printf("\n");
+	free(is_stale);
+
+	if(kmat_save(km, argv[3]) != 0){
+		fprintf(stderr, "CAN NOT WRITE %s\n", argv[3]);
+		return 1;
+	}
+
+	fprintf(stderr, "FUNCS: %d AFFECTED: %d MUTANTS: %d CARRIED: %d STALE: %d\n",
+		cur.func_num, affected, cur.mut_num, carried, stale);
+
+	kmat_free(km);
+	kmat_free(old);
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+* Micro benchmark of the equivalence class partition of the DMA runtime.
+* Compares the old linear scan over the classes with the value keyed
+* open addressing partition in accmut_eqclass.c.
+*
+* gcc -O2 -I../link eqclass_bench.c ../link/accmut_eqclass.c -o eqclass_bench
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "accmut_eqclass.h"
+
+#define MAX_N 4096
+#define ROUNDS 2000
+
+static long values[MAX_N];
+static int ids[MAX_N];
+
+static Eqclass classes[MAX_N];
+static int members[MAX_N];
+static int cls_of[MAX_N];
+static unsigned stamp[2 * MAX_N];
+static int slot[2 * MAX_N];
+
+/* the old divide: every value is compared with every class found so far */
+typedef struct LinearEqclass {
+	long value;
+	int num;
+	int mut_id[MAX_N];
+} LinearEqclass;
+
+static LinearEqclass linear_classes[MAX_N];
+
+static int linear_partition(int n){
+	int eq_num = 0;
+	int i, j;
+	for(i = 0; i < n; ++i){
+		int flag = 0;
+		for(j = 0; j < eq_num; ++j){
+			if(linear_classes[j].value == values[i]){
+				linear_classes[j].mut_id[linear_classes[j].num++] = ids[i];
+				flag = 1;
+				break;
+			}
+		}
+		if(flag == 0){
+			linear_classes[eq_num].value = values[i];
+			linear_classes[eq_num].num = 1;
+			linear_classes[eq_num].mut_id[0] = ids[i];
+			++eq_num;
+		}
+	}
+	return eq_num;
+}
+
+static double now_ns(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run(int n, int distinct){
+	int i, r;
+	for(i = 0; i < n; i++){
+		values[i] = (long)(rand() % distinct) * 7919;
+		ids[i] = i;
+	}
+
+	EqclassHash hash;
+	hash.gen = 0;
+	hash.mask = 1;
+	while(hash.mask + 1 < 2 * (unsigned)n){
+		hash.mask = (hash.mask << 1) | 1;
+	}
+	hash.stamp = stamp;
+	hash.cls = slot;
+
+	int lnum = 0, hnum = 0;
+
+	double begin = now_ns();
+	for(r = 0; r < ROUNDS; r++){
+		lnum = linear_partition(n);
+	}
+	double linear = (now_ns() - begin) / ROUNDS;
+
+	begin = now_ns();
+	for(r = 0; r < ROUNDS; r++){
+		hnum = __accmut__partition_eqclass(values, ids, n, classes, members, cls_of, &hash);
+	}
+	double hashed = (now_ns() - begin) / ROUNDS;
+
+	if(lnum != hnum){
+		fprintf(stderr, "CLASS NUM MISMATCH: %d %d\n", lnum, hnum);
+		exit(1);
+	}
+
+	printf("MUTS %5d  CLASSES %5d  LINEAR %12.1f ns  HASH %10.1f ns  SPEEDUP %8.2f\n",
+		n, hnum, linear, hashed, linear / hashed);
+}
+
+int main(){
+	int sizes[] = {64, 256, 4096};
+	int i;
+	srand(1);
+	for(i = 0; i < 3; i++){
+		int n = sizes[i];
+		run(n, 1);
+		run(n, 2);
+		run(n, n / 8);
+		run(n, n);
+	}
+	return 0;
+}
@@ -0,0 +1,161 @@
+/*
+* Runs a test suite through the fork server of an instrumented program
+* (see link/accmut_forksrv.h), so the program is loaded and initialized once
+* instead of once per test.
+*
+* usage: forkrun TESTS PROGRAM
+*
+* Every line of TESTS is one test: the test id, the arguments, and optional
+* "< FILE" and "> FILE" redirections, separated by blanks. forkrun prints
+* the test id and the exit code (or the signal) of every test.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "accmut_forksrv.h"
+#include "accmut_testlist.h"
+
+#define LINE_MAX_LEN 4096
+
+static int REQ_FD = -1;
+static int REP_FD = -1;
+
+static int read_full(int fd, void *buf, size_t len){
+	size_t done = 0;
+	while(done < len){
+		ssize_t r = read(fd, (char *)buf + done, len - done);
+		if(r <= 0){
+			return -1;
+		}
+		done += r;
+	}
+	return 0;
+}
+
+static int write_full(int fd, const void *buf, size_t len){
+	size_t done = 0;
+	while(done < len){
+		ssize_t r = write(fd, (const char *)buf + done, len - done);
+		if(r <= 0){
+			return -1;
+		}
+		done += r;
+	}
+	return 0;
+}
+
+static pid_t start_server(const char *prog){
+	int req[2], rep[2];
+	if(pipe(req) < 0 || pipe(rep) < 0){
+		perror("pipe");
+		exit(1);
+	}
+
+	pid_t pid = fork();
+	if(pid < 0){
+		perror("fork");
+		exit(1);
+	}
+	if(pid == 0){
+		dup2(req[0], ACCMUT_FORKSRV_FD);
+		dup2(rep[1], ACCMUT_FORKSRV_FD + 1);
+		close(req[0]);
+		close(req[1]);
+		close(rep[0]);
+		close(rep[1]);
+		setenv(ACCMUT_FORKSRV_ENV, "1", 1);
+		execl(prog, prog, (char *)NULL);
+		perror("exec");
+		_exit(127);
+	}
+
+	close(req[0]);
+	close(rep[1]);
+	REQ_FD = req[1];
+	REP_FD = rep[0];
+
+	int hello;
+	if(read_full(REP_FD, &hello, sizeof(hello)) < 0){
+		fprintf(stderr, "NO FORK SERVER IN %s\n", prog);
+		exit(1);
+	}
+	return pid;
+}
+
+/* the request of a test, the strings go to strs */
+static void make_request(const AccmutTest *t, AccmutForkReq *req, char *strs){
+	int i, size = 0;
+	for(i = 0; i < t->argc; i++){
+		strcpy(strs + size, t->argv[i]);
+		size += strlen(t->argv[i]) + 1;
+	}
+	strcpy(strs + size, t->in != NULL ? t->in : "");
+	size += strlen(strs + size) + 1;
+	strcpy(strs + size, t->out != NULL ? t->out : "");
+	size += strlen(strs + size) + 1;
+
+	req->test_id = t->test_id;
+	req->argc = t->argc;
+	req->size = size;
+	req->reserved = 0;
+}
+
+int main(int argc, char **argv){
+	if(argc != 3){
+		fprintf(stderr, "usage: %s TESTS PROGRAM\n", argv[0]);
+		return 1;
+	}
+
+	int num;
+	AccmutTest *tests = testlist_load(argv[1], &num);
+	if(tests == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", argv[1]);
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+
+	struct timeval tv_begin, tv_end;
+	gettimeofday(&tv_begin, NULL);
+
+	pid_t server = start_server(argv[2]);
+
+	static char strs[2 * LINE_MAX_LEN];
+	int i;
+	for(i = 0; i < num; i++){
+		AccmutForkReq req;
+		make_request(&tests[i], &req, strs);
+
+		AccmutForkRep rep;
+		if(write_full(REQ_FD, &req, sizeof(req)) < 0 || write_full(REQ_FD, strs, req.size) < 0
+			|| read_full(REP_FD, &rep, sizeof(rep)) < 0){
+			fprintf(stderr, "FORK SERVER DIED AT TEST %d\n", req.test_id);
+			return 1;
+		}
+
+		if(WIFSIGNALED(rep.status)){
+			printf("%d SIG %d\n", rep.test_id, WTERMSIG(rep.status));
+		}else{
+			printf("%d %d\n", rep.test_id, WEXITSTATUS(rep.status));
+		}
+	}
+
+	close(REQ_FD);
+	waitpid(server, NULL, 0);
+
+	gettimeofday(&tv_end, NULL);
+	long real_sec =  tv_end.tv_sec - tv_begin.tv_sec;
+	long real_usec = tv_end.tv_usec - tv_begin.tv_usec;
+	if(real_usec < 0){
+		real_sec--;
+		real_usec += 1000000;
+	}
+	fprintf(stderr, "TESTS: %d TOTAL TIME: %ld %ld\n", num, real_sec, real_usec);
+	testlist_free(tests, num);
+	return 0;
+}
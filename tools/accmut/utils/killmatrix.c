@@ -0,0 +1,87 @@
+/*
+* Turns the result regions written by the runtime
+* ($HOME/tmp/accmut/results/<PROJECT>/t<TID>) into one kill matrix file.
+*
+* usage: killmatrix [-t] RESULT_DIR MATRIX_FILE
+*   -t  also dump every record as text: TID MID OUTCOME EXIT CPU(us) RSS(KB) COUNT
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "accmut_matrix.h"
+
+static const char *OUTCOME_NAME[] = {
+	"NOT_RUN", "RUNNING", "SURVIVED", "KILLED", "TIMEOUT", "CRASH", "EXIT_DIFF", "SKIPPED", "NOT_COVERED"
+};
+
+static void dump_records(const char *dir, const KillMatrix *km){
+	char path[512];
+	int t;
+	for(t = 0; t < km->test_num; t++){
+		snprintf(path, sizeof(path), "%s/t%d", dir, km->test_ids[t]);
+		size_t sz;
+		AccmutResultRegion *r = kmat_map_region(path, &sz);
+		if(r == NULL){
+			continue;
+		}
+		int m;
+		for(m = 0; m <= r->mut_num; m++){
+			int outcome = KMAT_CELL(km, t, m);
+			if(outcome == OUT_NOT_RUN){
+				continue;
+			}
+			AccmutResult *rec = &r->records[m];
+			printf("%d\t%d\t%s\t%d\t%ld\t%ld\t%ld\n", km->test_ids[t], m,
+				OUTCOME_NAME[outcome], rec->exit_code, rec->cpu_usec, rec->max_rss, rec->exec_count);
+		}
+		munmap(r, sz);
+	}
+}
+
+int main(int argc, char *argv[]){
+	int dump = 0;
+	int argi = 1;
+
+	if(argc > 1 && !strcmp(argv[1], "-t")){
+		dump = 1;
+		argi++;
+	}
+
+	if(argc - argi != 2){
+		fprintf(stderr, "usage: killmatrix [-t] RESULT_DIR MATRIX_FILE\n");
+		return 1;
+	}
+
+	KillMatrix *km = kmat_from_results(argv[argi]);
+	if(km == NULL){
+		return 1;
+	}
+
+	if(kmat_save(km, argv[argi + 1]) != 0){
+		fprintf(stderr, "WRITE ERR !! PATH: %s\n", argv[argi + 1]);
+		return 1;
+	}
+
+	if(dump){
+		dump_records(argv[argi], km);
+	}
+
+	int killed = 0;
+	int m, t;
+	for(m = 1; m <= km->mut_num; m++){
+		for(t = 0; t < km->test_num; t++){
+			if(kmat_is_killed(KMAT_CELL(km, t, m))){
+				killed++;
+				break;
+			}
+		}
+	}
+
+	fprintf(stderr, "TESTS: %d MUTS: %d KILLED: %d SCORE: %f\n", km->test_num, km->mut_num,
+		killed, km->mut_num > 0 ? (double)killed / km->mut_num : 0.0);
+
+	kmat_free(km);
+	return 0;
+}
@@ -0,0 +1,307 @@
+/*
+* Converts the mutation description between the text format
+* ($HOME/tmp/accmut/mutations.txt) and the binary database the runtime and
+* the instrumenters map ($HOME/tmp/accmut/mutations.db).
+*
+* usage: mutdb txt2db [TXT_FILE [DB_FILE]]
+*        mutdb db2txt [DB_FILE [TXT_FILE]]
+*        mutdb merge [SHARD_DIR]
+*
+* To sample the mutants by hand, edit mutations.txt and run mutdb txt2db.
+* A db older than the text is ignored by the runtime anyway.
+*
+* merge puts the shards of ACCMUT_GEN_MUT_SHARDS ($HOME/tmp/accmut/shards,
+* one directory per module, see MutationDB.h) together: the mutations.txt,
+* funchash.txt and tce.txt of the shards, in the order of the names of the
+* shards, replace the ones in $HOME/tmp/accmut, and the db is written from
+* the new mutations.txt. The ids are the same whatever the order the modules
+* were compiled in. Two mutants of different modules with the same key (a
+* static function copied into both) are told apart the way the generator
+* does in one function: the later one is hashed again.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "accmut_mutdb.h"
+
+static char TXT_PATH[256];
+static char DB_PATH[256];
+
+static int txt2db(const char *txt_path, const char *db_path){
+
+	FILE *fp = fopen(txt_path, "r");
+	if(fp == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", txt_path);
+		return 1;
+	}
+
+	int cap = 1024;
+	int mut_num = 0;
+	int name_num = 0;
+	Mutation *muts = (Mutation *)malloc(sizeof(Mutation) * cap);
+	AccmutDBLoc *locs = (AccmutDBLoc *)malloc(sizeof(AccmutDBLoc) * cap);
+	char **names = (char **)malloc(sizeof(char *) * cap);
+
+	char buff[MUTFILELINE];
+	char func[MUTFILELINE];
+	while(fgets(buff, MUTFILELINE, fp)){
+		if(mut_num == cap){
+			cap *= 2;
+			muts = (Mutation *)realloc(muts, sizeof(Mutation) * cap);
+			locs = (AccmutDBLoc *)realloc(locs, sizeof(AccmutDBLoc) * cap);
+			names = (char **)realloc(names, sizeof(char *) * cap);
+		}
+		if(muts == NULL || locs == NULL || names == NULL){
+			fprintf(stderr, "OUT OF MEMORY\n");
+			return 1;
+		}
+
+		int index;
+		if(__accmut__mutdb_parse_line(buff, &muts[mut_num], func, &index) != 0){
+			fprintf(stderr, "ERROR MUT TYPE: %d:%s", mut_num + 1, buff);
+			return 1;
+		}
+
+		//the mutants of a function are always together
+		if(name_num == 0 || strcmp(names[name_num - 1], func) != 0){
+			names[name_num++] = strdup(func);
+		}
+		locs[mut_num].name_off = name_num - 1;
+		locs[mut_num].index = index;
+		locs[mut_num].key = __accmut__mutdb_parse_key(buff);
+		mut_num++;
+	}
+	fclose(fp);
+
+	if(__accmut__mutdb_write(db_path, muts, locs, mut_num, names, name_num, txt_path) != 0){
+		fprintf(stderr, "CAN NOT WRITE %s\n", db_path);
+		return 1;
+	}
+	printf("%d MUTS OF %d FUNCS -> %s\n", mut_num, name_num, db_path);
+	return 0;
+}
+
+static int db2txt(const char *db_path, const char *txt_path){
+
+	AccmutMutDB db;
+	if(__accmut__mutdb_map(db_path, &db) != 0){
+		fprintf(stderr, "NOT A MUTATION DB: %s\n", db_path);
+		return 1;
+	}
+
+	FILE *fp = fopen(txt_path, "w");
+	if(fp == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", txt_path);
+		return 1;
+	}
+
+	char line[2 * MUTFILELINE];
+	int i;
+	for(i = 0; i < db.header->mut_num; i++){
+		__accmut__mutdb_format_line(line, &db.muts[i], db.strtab + db.locs[i].name_off, db.locs[i].index,
+			db.locs[i].key);
+		fputs(line, fp);
+	}
+	fclose(fp);
+
+	//the db stays in use, tell the runtime the new text is the same
+	if(!strcmp(txt_path, TXT_PATH)){
+		int func_num = db.header->func_num;
+		char **names = (char **)malloc(sizeof(char *) * (func_num + 1));
+		AccmutDBLoc *locs = (AccmutDBLoc *)malloc(sizeof(AccmutDBLoc) * (db.header->mut_num + 1));
+		int f;
+		for(f = 0; f < func_num; f++){
+			names[f] = db.strtab + db.funcs[f].name_off;
+			for(i = db.funcs[f].first - 1; i < db.funcs[f].first - 1 + db.funcs[f].count; i++){
+				locs[i].name_off = f;
+				locs[i].index = db.locs[i].index;
+				locs[i].key = db.locs[i].key;
+			}
+		}
+		if(__accmut__mutdb_write(db_path, db.muts, locs, db.header->mut_num, names, func_num, txt_path) != 0){
+			fprintf(stderr, "CAN NOT WRITE %s\n", db_path);
+			return 1;
+		}
+	}
+
+	printf("%d MUTS OF %d FUNCS -> %s\n", db.header->mut_num, db.header->func_num, txt_path);
+	__accmut__mutdb_unmap(&db);
+	return 0;
+}
+
+static int cmp_str(const void *a, const void *b){
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* the set of the keys seen so far, open addressing, 0 is empty */
+static unsigned long *KEYS = NULL;
+static long KEY_CAP = 0;
+static long KEY_NUM = 0;
+
+static int key_insert(unsigned long key){
+	if(2 * (KEY_NUM + 1) > KEY_CAP){
+		unsigned long *old = KEYS;
+		long old_cap = KEY_CAP, i;
+		KEY_CAP = KEY_CAP > 0 ? KEY_CAP * 2 : 4096;
+		KEYS = (unsigned long *)calloc(KEY_CAP, sizeof(unsigned long));
+		KEY_NUM = 0;
+		for(i = 0; i < old_cap; i++){
+			if(old[i] != 0){
+				key_insert(old[i]);
+			}
+		}
+		free(old);
+	}
+	long h = (long)(key % (unsigned long)KEY_CAP);
+	while(KEYS[h] != 0){
+		if(KEYS[h] == key){
+			return 0;
+		}
+		h = (h + 1) % KEY_CAP;
+	}
+	KEYS[h] = key;
+	KEY_NUM++;
+	return 1;
+}
+
+/* append dir/name of every shard to out_path, 0 if no shard has one */
+static int merge_file(const char *shard_dir, char **shards, int shard_num, const char *name,
+		const char *out_path, int *mut_num){
+
+	char path[512], tmp[512];
+	int found = 0, i;
+	for(i = 0; i < shard_num && !found; i++){
+		snprintf(path, sizeof(path), "%s/%s/%s", shard_dir, shards[i], name);
+		found = access(path, R_OK) == 0;
+	}
+	if(!found){
+		return 0;
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.%d", out_path, getpid());
+	FILE *out = fopen(tmp, "w");
+	if(out == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", tmp);
+		return -1;
+	}
+
+	char buff[MUTFILELINE];
+	char func[MUTFILELINE];
+	for(i = 0; i < shard_num; i++){
+		snprintf(path, sizeof(path), "%s/%s/%s", shard_dir, shards[i], name);
+		FILE *fp = fopen(path, "r");
+		if(fp == NULL){
+			continue;
+		}
+		while(fgets(buff, MUTFILELINE, fp)){
+			if(mut_num != NULL){
+				Mutation m;
+				int index;
+				if(buff[0] == '\n'){
+					continue;
+				}
+				if(__accmut__mutdb_parse_line(buff, &m, func, &index) != 0){
+					fprintf(stderr, "ERROR MUT TYPE: %s:%s", path, buff);
+					fclose(fp);
+					fclose(out);
+					unlink(tmp);
+					return -1;
+				}
+				unsigned long key = __accmut__mutdb_parse_key(buff);
+				if(key != 0 && !key_insert(key)){
+					do{
+						key = (key ^ '#') * 0x100000001b3UL;
+					}while(!key_insert(key));
+					sprintf(strstr(buff, " #"), " #%016lx\n", key);
+				}
+				(*mut_num)++;
+			}
+			fputs(buff, out);
+		}
+		fclose(fp);
+	}
+
+	if(fclose(out) != 0 || rename(tmp, out_path) != 0){
+		fprintf(stderr, "CAN NOT WRITE %s\n", out_path);
+		unlink(tmp);
+		return -1;
+	}
+	return 1;
+}
+
+static int merge(const char *shard_dir){
+
+	DIR *d = opendir(shard_dir);
+	if(d == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", shard_dir);
+		return 1;
+	}
+	int cap = 64, shard_num = 0;
+	char **shards = (char **)malloc(sizeof(char *) * cap);
+	struct dirent *e;
+	char path[512];
+	while((e = readdir(d)) != NULL){
+		struct stat sb;
+		snprintf(path, sizeof(path), "%s/%s", shard_dir, e->d_name);
+		if(e->d_name[0] == '.' || stat(path, &sb) != 0 || !S_ISDIR(sb.st_mode)){
+			continue;
+		}
+		if(shard_num == cap){
+			cap *= 2;
+			shards = (char **)realloc(shards, sizeof(char *) * cap);
+		}
+		shards[shard_num++] = strdup(e->d_name);
+	}
+	closedir(d);
+	//not the order of readdir, nor the one of the locale
+	qsort(shards, shard_num, sizeof(char *), cmp_str);
+
+	char dir[256];
+	sprintf(dir, "%s%s", getenv("HOME"), "/tmp/accmut");
+
+	int mut_num = 0;
+	if(merge_file(shard_dir, shards, shard_num, "mutations.txt", TXT_PATH, &mut_num) <= 0){
+		fprintf(stderr, "NO MUTANTS IN %s\n", shard_dir);
+		return 1;
+	}
+	snprintf(path, sizeof(path), "%s/funchash.txt", dir);
+	if(merge_file(shard_dir, shards, shard_num, "funchash.txt", path, NULL) < 0){
+		return 1;
+	}
+	snprintf(path, sizeof(path), "%s/tce.txt", dir);
+	if(merge_file(shard_dir, shards, shard_num, "tce.txt", path, NULL) < 0){
+		return 1;
+	}
+	printf("%d MUTS OF %d SHARDS -> %s\n", mut_num, shard_num, TXT_PATH);
+
+	return txt2db(TXT_PATH, DB_PATH);
+}
+
+int main(int argc, char *argv[]){
+
+	if(argc < 2 || argc > 4){
+		fprintf(stderr, "usage: mutdb txt2db [TXT_FILE [DB_FILE]]\n");
+		fprintf(stderr, "       mutdb db2txt [DB_FILE [TXT_FILE]]\n");
+		fprintf(stderr, "       mutdb merge [SHARD_DIR]\n");
+		return 1;
+	}
+
+	sprintf(TXT_PATH, "%s%s", getenv("HOME"), "/tmp/accmut/mutations.txt");
+	sprintf(DB_PATH, "%s%s", getenv("HOME"), "/tmp/accmut/mutations.db");
+
+	if(!strcmp(argv[1], "txt2db")){
+		return txt2db(argc > 2 ? argv[2] : TXT_PATH, argc > 3 ? argv[3] : DB_PATH);
+	}else if(!strcmp(argv[1], "db2txt")){
+		return db2txt(argc > 2 ? argv[2] : DB_PATH, argc > 3 ? argv[3] : TXT_PATH);
+	}else if(!strcmp(argv[1], "merge")){
+		char shard_dir[256];
+		sprintf(shard_dir, "%s%s", getenv("HOME"), "/tmp/accmut/shards");
+		return merge(argc > 2 ? argv[2] : shard_dir);
+	}
+
+	fprintf(stderr, "UNKNOWN COMMAND: %s\n", argv[1]);
+	return 1;
+}
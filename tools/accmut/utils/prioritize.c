@@ -0,0 +1,375 @@
+/*
+* Orders a test suite so that with kill once the cheapest likely killer of
+* a mutant runs before the other tests, and reports the executions the order
+* saves against the order of the script.
+*
+* usage: prioritize [-c COVERAGE_DIR] [-i INDEX] TESTS OUT_TESTS MATRIX... REPLAY_MATRIX
+*
+*   -c  the coverage bitmaps t<TID> of the tests (see accmut_result.h), a
+*       test does not kill the mutants it does not reach
+*   -i  the timing index of calibrate, the cost of a test is its cpu time
+*       (50th percentile); without it every test costs the same
+*
+* The kill probability of a (test, mutant) is its kill rate over the kill
+* MATRIX of earlier campaigns (killmatrix or campaign); a pair never run
+* before gets the kill rate of the test. The mutants are the ones of
+* REPLAY_MATRIX, the columns of the others are matched to them by their
+* stable keys (see accmut_mutdb.h), so the history survives the ids changed
+* by a new generation; matrices without keys are matched by id. The tests are picked greedily: the
+* next one has the highest expected kills of the mutants still alive per
+* unit of cost, and the mutants it may kill count less for the tests after
+* it. The tests that are expected to kill nothing come last, the cheapest
+* first. OUT_TESTS is the ordered test list, for campaign or forkrun.
+*
+* The two orders are replayed on REPLAY_MATRIX, which should come from a
+* campaign without kill once: a mutant runs on every test until one kills
+* it, except on the tests that do not reach it. It is held out of the kill
+* probabilities, or the order would be fit on the results it is judged by.
+*   ORDER EXECUTIONS CPU(us) KILLED
+* and what the prioritized order saves goes to stderr.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "accmut_matrix.h"
+#include "accmut_testlist.h"
+#include "accmut_timing.h"
+#include "accmut_bitmap.h"
+
+static const char *COVERAGE_DIR = NULL;
+static const char *INDEX_PATH = NULL;
+
+static AccmutTest *TESTS = NULL;
+static int TEST_NUM = 0;
+static int MUT_NUM = 0;
+
+static long *COST = NULL;		/* of every test */
+
+/* the mutants a test may kill, with the probability */
+typedef struct Chance{
+	int mut;
+	float p;
+}Chance;
+
+static Chance **CHANCES = NULL;
+static int *CHANCE_NUM = NULL;
+
+/* the row of the test in km, -1 if it is not there */
+static int find_row(const KillMatrix *km, int test_id){
+	int r;
+	for(r = 0; r < km->test_num; r++){
+		if(km->test_ids[r] == test_id){
+			return r;
+		}
+	}
+	return -1;
+}
+
+static void load_costs(){
+	COST = (long *)malloc(sizeof(long) * (TEST_NUM > 0 ? TEST_NUM : 1));
+	int t;
+	for(t = 0; t < TEST_NUM; t++){
+		AccmutTiming tm;
+		COST[t] = 1;
+		if(INDEX_PATH != NULL && __accmut__timing_lookup(INDEX_PATH, TESTS[t].test_id, &tm) == 0 && tm.cpu_p50 > 0){
+			COST[t] = tm.cpu_p50;
+		}
+	}
+}
+
+typedef struct KeyCol{
+	unsigned long key;
+	int col;
+}KeyCol;
+
+static int cmp_keycol(const void *a, const void *b){
+	unsigned long x = ((const KeyCol *)a)->key, y = ((const KeyCol *)b)->key;
+	return x < y ? -1 : x > y;
+}
+
+/* the column of km of every mutant of ref, -1 if km does not have it */
+static int *map_columns(const KillMatrix *km, const KillMatrix *ref){
+	int *cols = (int *)malloc(sizeof(int) * (ref->mut_num + 1));
+	KeyCol *sorted = (KeyCol *)malloc(sizeof(KeyCol) * (km->mut_num + 1));
+	int num = 0, m;
+	for(m = 1; m <= km->mut_num; m++){
+		if(km->keys[m] != 0){
+			sorted[num].key = km->keys[m];
+			sorted[num].col = m;
+			num++;
+		}
+	}
+	qsort(sorted, num, sizeof(KeyCol), cmp_keycol);
+
+	cols[0] = 0;
+	for(m = 1; m <= ref->mut_num; m++){
+		if(num == 0 || ref->keys[m] == 0){
+			cols[m] = m <= km->mut_num ? m : -1;
+			continue;
+		}
+		KeyCol k = {ref->keys[m], 0};
+		KeyCol *found = (KeyCol *)bsearch(&k, sorted, num, sizeof(KeyCol), cmp_keycol);
+		cols[m] = found != NULL ? found->col : -1;
+	}
+	free(sorted);
+	return cols;
+}
+
+/* the kill probabilities from the history kms, for the mutants of ref */
+static void load_chances(KillMatrix **kms, int km_num, const KillMatrix *ref){
+	int k, t, m;
+	MUT_NUM = ref->mut_num;
+
+	int **cols = (int **)malloc(sizeof(int *) * km_num);
+	for(k = 0; k < km_num; k++){
+		cols[k] = map_columns(kms[k], ref);
+	}
+
+	int *runs = (int *)malloc(sizeof(int) * (MUT_NUM + 1));
+	int *kills = (int *)malloc(sizeof(int) * (MUT_NUM + 1));
+	CHANCES = (Chance **)calloc(TEST_NUM > 0 ? TEST_NUM : 1, sizeof(Chance *));
+	CHANCE_NUM = (int *)calloc(TEST_NUM > 0 ? TEST_NUM : 1, sizeof(int));
+
+	for(t = 0; t < TEST_NUM; t++){
+		memset(runs, 0, sizeof(int) * (MUT_NUM + 1));
+		memset(kills, 0, sizeof(int) * (MUT_NUM + 1));
+		long test_runs = 0, test_kills = 0;
+
+		for(k = 0; k < km_num; k++){
+			int row = find_row(kms[k], TESTS[t].test_id);
+			if(row < 0){
+				continue;
+			}
+			for(m = 1; m <= MUT_NUM; m++){
+				if(cols[k][m] < 0){
+					continue;
+				}
+				int outcome = KMAT_CELL(kms[k], row, cols[k][m]);
+				//killed by an earlier test, nothing is known
+				if(outcome == OUT_SKIPPED){
+					continue;
+				}
+				int killed = kmat_is_killed(outcome);
+				runs[m]++;
+				kills[m] += killed;
+				test_runs++;
+				test_kills += killed;
+			}
+		}
+
+		unsigned long *cov = COVERAGE_DIR != NULL ? kmat_load_coverage(COVERAGE_DIR, TESTS[t].test_id, MUT_NUM) : NULL;
+		float rate = test_runs > 0 ? (float)test_kills / test_runs : 0;
+
+		CHANCES[t] = (Chance *)malloc(sizeof(Chance) * (MUT_NUM + 1));
+		for(m = 1; m <= MUT_NUM; m++){
+			if(cov != NULL && !ACCMUT_BIT_TEST(cov, m)){
+				continue;
+			}
+			float p = runs[m] > 0 ? (float)kills[m] / runs[m] : rate;
+			if(p > 0){
+				CHANCES[t][CHANCE_NUM[t]].mut = m;
+				CHANCES[t][CHANCE_NUM[t]].p = p;
+				CHANCE_NUM[t]++;
+			}
+		}
+		free(cov);
+	}
+	for(k = 0; k < km_num; k++){
+		free(cols[k]);
+	}
+	free(cols);
+	free(runs);
+	free(kills);
+}
+
+/* the expected kills of the alive mutants per unit of cost */
+static double score(int t, const float *alive){
+	double s = 0;
+	int i;
+	for(i = 0; i < CHANCE_NUM[t]; i++){
+		s += alive[CHANCES[t][i].mut] * CHANCES[t][i].p;
+	}
+	return s / COST[t];
+}
+
+static int cmp_cost(const void *a, const void *b){
+	long x = COST[*(const int *)a], y = COST[*(const int *)b];
+	return x < y ? -1 : x > y ? 1 : *(const int *)a - *(const int *)b;
+}
+
+static int *prioritize(){
+	int *order = (int *)malloc(sizeof(int) * (TEST_NUM > 0 ? TEST_NUM : 1));
+	int *picked = (int *)calloc(TEST_NUM > 0 ? TEST_NUM : 1, sizeof(int));
+	double *stale = (double *)malloc(sizeof(double) * (TEST_NUM > 0 ? TEST_NUM : 1));
+	//the probability that a mutant is still alive
+	float *alive = (float *)malloc(sizeof(float) * (MUT_NUM + 1));
+	int t, m, num = 0;
+
+	for(m = 0; m <= MUT_NUM; m++){
+		alive[m] = 1;
+	}
+	for(t = 0; t < TEST_NUM; t++){
+		stale[t] = score(t, alive);
+	}
+
+	//the scores only go down as the mutants die, so a test still on top
+	//after its score is computed again is the best one (lazy greedy)
+	while(num < TEST_NUM){
+		int best = -1;
+		for(t = 0; t < TEST_NUM; t++){
+			if(!picked[t] && (best < 0 || stale[t] > stale[best])){
+				best = t;
+			}
+		}
+		if(stale[best] <= 0){
+			break;
+		}
+		stale[best] = score(best, alive);
+		int top = 1;
+		for(t = 0; t < TEST_NUM; t++){
+			if(!picked[t] && t != best && stale[t] > stale[best]){
+				top = 0;
+				break;
+			}
+		}
+		if(!top){
+			continue;
+		}
+		if(stale[best] <= 0){
+			break;
+		}
+
+		picked[best] = 1;
+		order[num++] = best;
+		int i;
+		for(i = 0; i < CHANCE_NUM[best]; i++){
+			alive[CHANCES[best][i].mut] *= 1 - CHANCES[best][i].p;
+		}
+	}
+
+	int rest = num;
+	for(t = 0; t < TEST_NUM; t++){
+		if(!picked[t]){
+			order[num++] = t;
+		}
+	}
+	qsort(order + rest, num - rest, sizeof(int), cmp_cost);
+
+	free(picked);
+	free(stale);
+	free(alive);
+	return order;
+}
+
+/* run the tests in the order on ref with kill once */
+static void replay(const char *name, const KillMatrix *ref, const int *order, long *execs_out, long *cpu_out){
+	unsigned long *dead = (unsigned long *)calloc(ACCMUT_BITMAP_WORDS(MUT_NUM + 1), sizeof(unsigned long));
+	long execs = 0, cpu = 0;
+	int killed = 0;
+	int i, m;
+	for(i = 0; i < TEST_NUM; i++){
+		int t = order[i];
+		int row = find_row(ref, TESTS[t].test_id);
+		if(row < 0){
+			continue;
+		}
+		for(m = 1; m <= ref->mut_num; m++){
+			int outcome = KMAT_CELL(ref, row, m);
+			if(ACCMUT_BIT_TEST(dead, m) || outcome == OUT_NOT_COVERED){
+				continue;
+			}
+			execs++;
+			cpu += COST[t];
+			if(kmat_is_killed(outcome)){
+				ACCMUT_BIT_SET(dead, m);
+				killed++;
+			}
+		}
+	}
+	printf("%s\t%ld\t%ld\t%d\n", name, execs, cpu, killed);
+	*execs_out = execs;
+	*cpu_out = cpu;
+	free(dead);
+}
+
+static void usage(const char *prog){
+	fprintf(stderr, "usage: %s [-c COVERAGE_DIR] [-i INDEX] TESTS OUT_TESTS MATRIX... REPLAY_MATRIX\n", prog);
+	exit(1);
+}
+
+int main(int argc, char **argv){
+	int opt;
+	while((opt = getopt(argc, argv, "c:i:")) != -1){
+		switch(opt){
+			case 'c':
+				COVERAGE_DIR = optarg;
+				break;
+			case 'i':
+				INDEX_PATH = optarg;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+	//at least one matrix of history besides the replayed one
+	if(argc - optind < 4){
+		usage(argv[0]);
+	}
+
+	TESTS = testlist_load(argv[optind], &TEST_NUM);
+	if(TESTS == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", argv[optind]);
+		return 1;
+	}
+
+	int km_num = argc - optind - 2;
+	KillMatrix **kms = (KillMatrix **)malloc(sizeof(KillMatrix *) * km_num);
+	int k;
+	for(k = 0; k < km_num; k++){
+		kms[k] = kmat_load(argv[optind + 2 + k]);
+		if(kms[k] == NULL){
+			fprintf(stderr, "CAN NOT LOAD MATRIX %s\n", argv[optind + 2 + k]);
+			return 1;
+		}
+	}
+
+	load_costs();
+	KillMatrix *ref = kms[km_num - 1];
+	load_chances(kms, km_num - 1, ref);
+
+	int *order = prioritize();
+	if(testlist_save(TESTS, order, TEST_NUM, argv[optind + 1]) != 0){
+		fprintf(stderr, "CAN NOT WRITE %s\n", argv[optind + 1]);
+		return 1;
+	}
+
+	int *script = (int *)malloc(sizeof(int) * (TEST_NUM > 0 ? TEST_NUM : 1));
+	int t;
+	for(t = 0; t < TEST_NUM; t++){
+		script[t] = t;
+	}
+	long script_execs, script_cpu, execs, cpu;
+	printf("ORDER\tEXECUTIONS\tCPU(us)\tKILLED\n");
+	replay("SCRIPT", ref, script, &script_execs, &script_cpu);
+	replay("PRIORITIZED", ref, order, &execs, &cpu);
+	fprintf(stderr, "SAVED EXECUTIONS: %ld (%.1f%%) SAVED CPU: %ld us (%.1f%%)\n",
+		script_execs - execs, script_execs > 0 ? 100.0 * (script_execs - execs) / script_execs : 0.0,
+		script_cpu - cpu, script_cpu > 0 ? 100.0 * (script_cpu - cpu) / script_cpu : 0.0);
+
+	for(k = 0; k < km_num; k++){
+		kmat_free(kms[k]);
+	}
+	for(t = 0; t < TEST_NUM; t++){
+		free(CHANCES[t]);
+	}
+	free(kms);
+	free(CHANCES);
+	free(CHANCE_NUM);
+	free(COST);
+	free(script);
+	free(order);
+	testlist_free(TESTS, TEST_NUM);
+	return 0;
+}
@@ -0,0 +1,163 @@
+/*
+* Counts the read and write system calls of forked children doing their
+* stdio with libc, and with the in-memory buffers of accmut_io.c.
+*
+* usage: stdio_bench [-n CHILDREN] INPUT_FILE < INPUT
+*
+* make builds it twice: stdio_bench uses libc, stdio_bench_io is linked with
+* ../link/accmut_io.c and $(WRAP_FLAGS). Like a forked mutant, every child
+* reads stdin with scanf and INPUT_FILE with fgets, fgetc, ungetc, fseek,
+* ftell, rewind and fread again, and prints what it has read. The counts are
+* taken from syscr and syscw of /proc/self/io.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#ifdef ACCMUT_STDIO_BENCH_IO
+//what accmut_io.c needs from the rest of the runtime
+int HOLDER[1024];
+int TEST_ID = 0;
+const char PROJECT[] = "stdio_bench";
+
+int __accmut__represented_muts(const int **muts){
+	*muts = HOLDER;
+	return 1;
+}
+void __accmut__result_abort(int outcome, int exitcd){}
+void __accmut__sched_release(){}
+void __accmut__init_stdstream();
+#endif
+
+/* syscr and syscw of the process */
+static void io_count(long *r, long *w){
+	char buf[512];
+	int fd = open("/proc/self/io", O_RDONLY);
+	ssize_t n = fd < 0 ? -1 : read(fd, buf, sizeof(buf) - 1);
+	if(fd >= 0){
+		close(fd);
+	}
+	*r = *w = 0;
+	if(n <= 0){
+		return;
+	}
+	buf[n] = '\0';
+	char *p = strstr(buf, "syscr:");
+	if(p != NULL){
+		*r = atol(p + 6);
+	}
+	p = strstr(buf, "syscw:");
+	if(p != NULL){
+		*w = atol(p + 6);
+	}
+}
+
+static void child_work(FILE *fp){
+	long sum = 0;
+	int v;
+	rewind(stdin);
+	while(scanf("%d", &v) == 1){
+		sum += v;
+	}
+
+	char line[256];
+	int lines = 0;
+	rewind(fp);
+	while(fgets(line, sizeof(line), fp) != NULL){
+		lines++;
+		printf("%d: %s", lines, line);
+	}
+
+	long chars = 0;
+	int c;
+	rewind(fp);
+	while((c = fgetc(fp)) != EOF){
+		if(++chars % 100 == 0){
+			ungetc(fgetc(fp), fp);
+		}
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	char block[64];
+	size_t blocks = 0;
+	while(fread(block, sizeof(block), 1, fp) == 1){
+		blocks++;
+	}
+
+	printf("sum %ld lines %d chars %ld size %ld blocks %zu\n", sum, lines, chars, size, blocks);
+	fflush(stdout);
+}
+
+int main(int argc, char **argv){
+	int children = 100;
+	int opt;
+	while((opt = getopt(argc, argv, "n:")) != -1){
+		if(opt == 'n' && atoi(optarg) > 0){
+			children = atoi(optarg);
+		}else{
+			dprintf(2, "usage: %s [-n CHILDREN] INPUT_FILE < INPUT\n", argv[0]);
+			return 1;
+		}
+	}
+	if(argc - optind != 1){
+		dprintf(2, "usage: %s [-n CHILDREN] INPUT_FILE < INPUT\n", argv[0]);
+		return 1;
+	}
+
+	#ifdef ACCMUT_STDIO_BENCH_IO
+	__accmut__init_stdstream();
+	#endif
+
+	FILE *fp = fopen(argv[optind], "r");
+	if(fp == NULL){
+		dprintf(2, "CAN NOT OPEN %s\n", argv[optind]);
+		return 1;
+	}
+
+	int pfd[2];
+	if(pipe(pfd) < 0){
+		perror("pipe");
+		return 1;
+	}
+
+	long total_r = 0, total_w = 0;
+	int i;
+	for(i = 1; i <= children; i++){
+		pid_t pid = fork();
+		if(pid < 0){
+			perror("fork");
+			return 1;
+		}
+		if(pid == 0){
+			#ifdef ACCMUT_STDIO_BENCH_IO
+			HOLDER[0] = i;
+			#endif
+			long r0, w0, r1, w1;
+			io_count(&r0, &w0);
+			child_work(fp);
+			io_count(&r1, &w1);
+			long d[2] = {r1 - r0, w1 - w0};
+			if(write(pfd[1], d, sizeof(d)) != sizeof(d)){
+				_exit(1);
+			}
+			_exit(0);
+		}
+		waitpid(pid, NULL, 0);
+		long d[2];
+		if(read(pfd[0], d, sizeof(d)) == sizeof(d)){
+			total_r += d[0];
+			total_w += d[1];
+		}
+	}
+
+	//one read of the counters is counted in every child
+	dprintf(2, "CHILDREN: %d READ SYSCALLS: %ld WRITE SYSCALLS: %ld PER CHILD: %.1f %.1f\n",
+		children, total_r, total_w, (double)total_r / children, (double)total_w / children);
+	return 0;
+}
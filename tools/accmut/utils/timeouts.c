@@ -0,0 +1,131 @@
+/*
+* Reports the timeout rate of every location (instruction) with mutants,
+* to spot the budgets that are too tight (many mutants of a location time
+* out on tests the others pass) or the loops the mutants make infinite.
+*
+* usage: timeouts MATRIX_FILE [MUTATIONS_TXT]
+*
+* MATRIX_FILE is a kill matrix of killmatrix or campaign, MUTATIONS_TXT is
+* $HOME/tmp/accmut/mutations.txt by default. Prints the locations with
+* timeouts, the highest rate first:
+*   FUNC:INDEX MUTANTS CELLS TIMEOUTS RATE TIMED_OUT_MUTANTS
+* CELLS are the (test, mutant) pairs of the location, without the skipped ones.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accmut_matrix.h"
+#include "accmut_mutdb.h"
+
+typedef struct LocStat{
+	char *func;
+	int index;
+	int muts;
+	long cells;
+	long timeouts;
+	int timed_out_muts;
+}LocStat;
+
+static int cmp_rate(const void *a, const void *b){
+	const LocStat *x = (const LocStat *)a, *y = (const LocStat *)b;
+	double rx = x->cells > 0 ? (double)x->timeouts / x->cells : 0;
+	double ry = y->cells > 0 ? (double)y->timeouts / y->cells : 0;
+	return rx < ry ? 1 : rx > ry ? -1 : 0;
+}
+
+int main(int argc, char **argv){
+	if(argc != 2 && argc != 3){
+		fprintf(stderr, "usage: timeouts MATRIX_FILE [MUTATIONS_TXT]\n");
+		return 1;
+	}
+
+	KillMatrix *km = kmat_load(argv[1]);
+	if(km == NULL){
+		fprintf(stderr, "INVALID MATRIX: %s\n", argv[1]);
+		return 1;
+	}
+
+	char txt_path[256];
+	if(argc == 3){
+		snprintf(txt_path, sizeof(txt_path), "%s", argv[2]);
+	}else{
+		snprintf(txt_path, sizeof(txt_path), "%s/tmp/accmut/mutations.txt", getenv("HOME"));
+	}
+	FILE *fp = fopen(txt_path, "r");
+	if(fp == NULL){
+		fprintf(stderr, "CAN NOT OPEN %s\n", txt_path);
+		return 1;
+	}
+
+	int cap = 256, loc_num = 0;
+	LocStat *locs = (LocStat *)calloc(cap, sizeof(LocStat));
+
+	char buff[MUTFILELINE];
+	char func[MUTFILELINE];
+	int m = 0;
+	long all_cells = 0, all_timeouts = 0;
+	while(fgets(buff, MUTFILELINE, fp) && m < km->mut_num){
+		Mutation mut;
+		int index;
+		if(__accmut__mutdb_parse_line(buff, &mut, func, &index) != 0){
+			fprintf(stderr, "ERROR MUT TYPE: %d:%s", m + 1, buff);
+			return 1;
+		}
+		m++;
+		index = abs(index);
+
+		//the mutants of a location are always together
+		if(loc_num == 0 || locs[loc_num - 1].index != index || strcmp(locs[loc_num - 1].func, func) != 0){
+			if(loc_num == cap){
+				cap *= 2;
+				locs = (LocStat *)realloc(locs, sizeof(LocStat) * cap);
+			}
+			memset(&locs[loc_num], 0, sizeof(LocStat));
+			locs[loc_num].func = strdup(func);
+			locs[loc_num].index = index;
+			loc_num++;
+		}
+		LocStat *l = &locs[loc_num - 1];
+		l->muts++;
+
+		int t, timed_out = 0;
+		for(t = 0; t < km->test_num; t++){
+			int outcome = KMAT_CELL(km, t, m);
+			if(outcome == OUT_SKIPPED || outcome == OUT_NOT_COVERED){
+				continue;
+			}
+			l->cells++;
+			if(outcome == OUT_TIMEOUT){
+				l->timeouts++;
+				timed_out = 1;
+			}
+		}
+		l->timed_out_muts += timed_out;
+	}
+	fclose(fp);
+
+	qsort(locs, loc_num, sizeof(LocStat), cmp_rate);
+
+	int i;
+	for(i = 0; i < loc_num; i++){
+		LocStat *l = &locs[i];
+		all_cells += l->cells;
+		all_timeouts += l->timeouts;
+		if(l->timeouts == 0){
+			continue;
+		}
+		printf("%s:%d\t%d\t%ld\t%ld\t%f\t%d\n", l->func, l->index, l->muts, l->cells,
+			l->timeouts, (double)l->timeouts / l->cells, l->timed_out_muts);
+	}
+
+	fprintf(stderr, "LOCATIONS: %d CELLS: %ld TIMEOUTS: %ld RATE: %f\n", loc_num, all_cells,
+		all_timeouts, all_cells > 0 ? (double)all_timeouts / all_cells : 0.0);
+
+	for(i = 0; i < loc_num; i++){
+		free(locs[i].func);
+	}
+	free(locs);
+	kmat_free(km);
+	return 0;
+}
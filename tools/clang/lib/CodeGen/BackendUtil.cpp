@@ -61,7 +61,7 @@
 #include "llvm/Transforms/AccMut/SMAInstrumenter.h"
 #endif
 
-#if ACCMUT_STATISTICS_INSTRUEMENT
+#if (ACCMUT_STATISTICS_INSTRUEMENT || ACCMUT_EXEC_BUDGET_INSTRUMENT)
 #include "llvm/Transforms/AccMut/StatisticsUtils.h"
 #endif
 
@@ -646,6 +646,10 @@ SMAInstrumenter *smaInstruEval;
 ExecInstNums *execinstnum;
 #endif
 
+#if ACCMUT_EXEC_BUDGET_INSTRUMENT
+ExecBudget *execbudget;
+#endif
+
 //-----------end-------------------
 
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
@@ -730,6 +734,11 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 		execinstnum = new ExecInstNums(TheModule);
 		AccmutInstFuncPasses->add(execinstnum);
 	#endif
+
+	#if ACCMUT_EXEC_BUDGET_INSTRUMENT
+		execbudget = new ExecBudget(TheModule);
+		AccmutInstFuncPasses->add(execbudget);
+	#endif
 		
 		PrettyStackTraceString CrashInfo("ACCMUT DMA instrument passes");
 		AccmutInstFuncPasses->doInitialization();